@@ -0,0 +1,94 @@
+#include "bench_support.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#include "linux_parser.h"
+#include "proc_synth.h"
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+}  // namespace
+
+// Count every allocation of the benchmark binary; the aligned and nothrow
+// forms are rare enough here to leave to the library.
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+ProcSource const& Bench::Source(long pids) {
+  static std::mutex mutex;
+  static std::map<long, std::unique_ptr<SnapshotSource>> trees;
+  if (pids == 0) return ProcSource::Live();
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<SnapshotSource>& tree = trees[pids];
+  if (!tree) {
+    tree = std::make_unique<SnapshotSource>();
+    SnapshotSource& snapshot = *tree;
+    ProcSynth::Synthesize(
+        [&snapshot](std::string const& path, std::string const& contents) {
+          snapshot.Add(path, contents);
+          return true;
+        },
+        int(pids), 8, 1);
+  }
+  return *tree;
+}
+
+ProcSource const& Bench::CgroupSource(long pids) {
+  static std::mutex mutex;
+  static std::map<long, std::unique_ptr<SnapshotSource>> trees;
+  if (pids == 0) return LinuxParser::CgroupSource();
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<SnapshotSource>& tree = trees[pids];
+  if (!tree) {
+    tree = std::make_unique<SnapshotSource>();
+    SnapshotSource& snapshot = *tree;
+    ProcSynth::SynthesizeCgroups(
+        [&snapshot](std::string const& path, std::string const& contents) {
+          snapshot.Add(path, contents);
+          return true;
+        },
+        int(pids), 1);
+  }
+  return *tree;
+}
+
+Bench::ScopedSource::ScopedSource(long pids)
+    : cgroups_(LinuxParser::CgroupSource()) {
+  LinuxParser::SetSource(Source(pids));
+  LinuxParser::SetCgroupSource(CgroupSource(pids));
+}
+
+Bench::ScopedSource::~ScopedSource() {
+  LinuxParser::SetSource(ProcSource::Live());
+  LinuxParser::SetCgroupSource(cgroups_);
+}
+
+std::size_t Bench::Allocations() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+void Bench::SetPerPidCounters(benchmark::State& state, std::size_t pids) {
+  state.SetItemsProcessed(state.iterations() * pids);
+  state.counters["time_per_pid"] = benchmark::Counter(
+      double(state.iterations() * pids),
+      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+void Bench::SetAllocationCounter(benchmark::State& state, std::size_t before) {
+  state.counters["allocs"] = benchmark::Counter(
+      double(Allocations() - before), benchmark::Counter::kAvgIterations);
+}
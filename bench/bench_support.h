@@ -0,0 +1,47 @@
+#ifndef BENCH_SUPPORT_H
+#define BENCH_SUPPORT_H
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+#include "proc_source.h"
+
+// Shared by the benchmarks: the /proc tree a benchmark runs against, and
+// the counters used to compare runs.
+
+namespace Bench {
+// Synthetic PIDs in the snapshot selected by an argument of kSynthetic.
+int const kSynthetic{10000};
+
+// Argument 0 selects the live /proc; any other value selects an in-memory
+// synthetic tree with that many PIDs, built once and kept for the run.
+ProcSource const& Source(long pids);
+// The cgroup hierarchy the processes of Source(pids) are in: the live one
+// for 0, else a synthetic one.
+ProcSource const& CgroupSource(long pids);
+
+// Points LinuxParser at Source(pids) and CgroupSource(pids) for the
+// lifetime of the object.
+class ScopedSource {
+ public:
+  explicit ScopedSource(long pids);
+  ~ScopedSource();
+  ScopedSource(ScopedSource const&) = delete;
+  ScopedSource& operator=(ScopedSource const&) = delete;
+
+ private:
+  ProcSource const& cgroups_;  // the live hierarchy, to restore
+};
+
+// Calls to operator new made so far, by any thread.
+std::size_t Allocations();
+
+// Reports time per PID alongside the usual per-iteration time.
+void SetPerPidCounters(benchmark::State& state, std::size_t pids);
+// Reports the allocations made since before (a value of Allocations()) as
+// allocations per iteration.
+void SetAllocationCounter(benchmark::State& state, std::size_t before);
+};  // namespace Bench
+
+#endif
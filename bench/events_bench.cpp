@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "bench_support.h"
+#include "proc_events.h"
+
+// The live PID list kept by process events, against the /proc scan it
+// replaces (BM_Pids/0), and the cost of bursts of short-lived children.
+// Both skip when the proc connector is unavailable; tools/eventcheck checks
+// that every such child is reported.
+
+namespace {
+
+void BM_ProcEventsPids(benchmark::State& state) {
+  ProcEvents events;
+  if (!events.Start()) {
+    state.SkipWithError(std::strerror(errno));
+    return;
+  }
+  std::vector<int> pids;
+  ProcEventCounts counts;
+  events.Pids(pids, counts);
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    events.Pids(pids, counts);
+    benchmark::DoNotOptimize(pids.data());
+  }
+  Bench::SetAllocationCounter(state, allocations);
+  Bench::SetPerPidCounters(state, pids.size());
+}
+BENCHMARK(BM_ProcEventsPids);
+
+// Each iteration forks a burst of children that exit at once, reaps them
+// and takes a listing, as one frame would. short_lived is per child forked
+// and includes other activity on the host.
+void BM_ProcEventsBurst(benchmark::State& state) {
+  ProcEvents events;
+  if (!events.Start()) {
+    state.SkipWithError(std::strerror(errno));
+    return;
+  }
+  int const burst = int(state.range(0));
+  std::vector<int> pids;
+  ProcEventCounts counts;
+  events.Pids(pids, counts);
+  unsigned long spawned{0};
+  unsigned long short_lived{0};
+  for (auto _ : state) {
+    for (int i = 0; i < burst; ++i) {
+      pid_t const child = fork();
+      if (child == 0) _exit(0);
+      if (child > 0) ++spawned;
+    }
+    while (wait(nullptr) > 0) {
+    }
+    // The exits are queued on the socket before wait() returns; give the
+    // listener thread time to apply them.
+    state.PauseTiming();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    state.ResumeTiming();
+    events.Pids(pids, counts);
+    short_lived += counts.short_lived;
+  }
+  state.counters["short_lived"] =
+      benchmark::Counter(double(short_lived) / double(spawned));
+}
+BENCHMARK(BM_ProcEventsBurst)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+
+}  // namespace
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "exporter.h"
+#include "frame.h"
+#include "history.h"
+
+// Cost of serializing one frame with ten process rows, as text and into the
+// binary history ring.
+
+namespace {
+
+Frame SyntheticFrame() {
+  Frame frame;
+  frame.sequence = 42;
+  frame.wall_time = std::chrono::system_clock::now();
+  frame.cpu_utilization = 0.42f;
+  frame.core_utilization.assign(64, 0.5f);
+  frame.cpu_deltas.assign(65, {50, 50});
+  frame.memory_utilization = 0.3f;
+  frame.total_processes = 123456;
+  frame.running_processes = 7;
+  frame.uptime = 86400;
+  for (int pid = 1; pid <= 10; ++pid) {
+    frame.processes.push_back({pid, "builder",
+                               "/usr/bin/cc1plus -O2 \"x.cpp\"", 0.01f * pid,
+                               (unsigned long)pid, 100L * pid, 3600, {}});
+  }
+  return frame;
+}
+
+void BM_Export(benchmark::State& state, Exporter::Format format) {
+  std::FILE* out = std::fopen("/dev/null", "w");
+  Exporter exporter(out, format);
+  Frame const frame = SyntheticFrame();
+  for (auto _ : state) {
+    exporter.Write(frame);
+  }
+  std::fclose(out);
+}
+BENCHMARK_CAPTURE(BM_Export, jsonl, Exporter::Format::kJsonLines);
+BENCHMARK_CAPTURE(BM_Export, csv, Exporter::Format::kCsv);
+
+void BM_HistoryRecord(benchmark::State& state) {
+  char path[] = "/tmp/monitor_bench_history_XXXXXX";
+  close(mkstemp(path));
+  HistoryWriter history;
+  history.Open(path, 600, 10);
+  Frame frame = SyntheticFrame();
+  for (auto _ : state) {
+    ++frame.sequence;
+    benchmark::DoNotOptimize(history.Record(frame));
+  }
+  unlink(path);
+}
+BENCHMARK(BM_HistoryRecord);
+
+}  // namespace
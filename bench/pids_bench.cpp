@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "bench_support.h"
+#include "proc_source.h"
+
+// PID enumeration alone, three ways: the std::filesystem loop the parser
+// started with, the opendir/readdir loop that replaced it, and the
+// getdents64 listing DirectorySource uses now. The argument picks the
+// directory: 0 for the live /proc, anything else a scratch directory with
+// that many PID directories, standing in for a host with that many tasks.
+
+namespace {
+
+// Scratch /proc-like roots: numbered directories plus a few of the
+// non-PID entries /proc has. Removed at exit.
+class PidTrees {
+ public:
+  ~PidTrees() {
+    for (auto const& [pids, root] : roots_) {
+      for (long pid = 1; pid <= pids; ++pid) {
+        rmdir((root + "/" + std::to_string(pid)).c_str());
+      }
+      rmdir((root + "/sys").c_str());
+      unlink((root + "/stat").c_str());
+      unlink((root + "/self").c_str());
+      rmdir(root.c_str());
+    }
+  }
+
+  std::string const& Root(long pids) {
+    std::string& root = roots_[pids];
+    if (!root.empty()) return root;
+    char name[] = "/tmp/monitor-pids-XXXXXX";
+    if (mkdtemp(name) == nullptr) return root;
+    root = name;
+    for (long pid = 1; pid <= pids; ++pid) {
+      mkdir((root + "/" + std::to_string(pid)).c_str(), 0755);
+    }
+    mkdir((root + "/sys").c_str(), 0755);
+    close(creat((root + "/stat").c_str(), 0644));
+    symlink("1", (root + "/self").c_str());
+    return root;
+  }
+
+ private:
+  std::map<long, std::string> roots_;
+};
+
+std::string Root(long pids) {
+  static PidTrees trees;
+  return pids == 0 ? std::string("/proc") : trees.Root(pids);
+}
+
+void SetCounters(benchmark::State& state, std::size_t pids,
+                 std::size_t allocations) {
+  Bench::SetAllocationCounter(state, allocations);
+  Bench::SetPerPidCounters(state, pids);
+}
+
+// LinuxParser::Pids() as first written.
+std::vector<int> DirectoryIteratorPids(std::string const& root) {
+  std::vector<int> pids;
+  for (const auto& entry : std::filesystem::directory_iterator(root)) {
+    if (entry.is_directory()) {
+      std::string filename = entry.path().filename().string();
+      if (all_of(filename.begin(), filename.end(), isdigit)) {
+        int pid = std::stoi(filename);
+        pids.push_back(pid);
+      }
+    }
+  }
+  return pids;
+}
+
+void BM_PidsDirectoryIterator(benchmark::State& state) {
+  std::string const root = Root(state.range(0));
+  size_t pids{0};
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    pids = DirectoryIteratorPids(root).size();
+  }
+  SetCounters(state, pids, allocations);
+}
+BENCHMARK(BM_PidsDirectoryIterator)->Arg(0)->Arg(100000);
+
+// DirectorySource::Pids() before getdents64: a DIR per call and a
+// freshly grown vector per frame.
+std::vector<int> ReaddirPids(std::string const& root) {
+  std::vector<int> pids;
+  DIR* directory = opendir(root.c_str());
+  if (directory == nullptr) return pids;
+  while (dirent const* entry = readdir(directory)) {
+    if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN) continue;
+    int pid{0};
+    char const* p = entry->d_name;
+    for (; *p >= '0' && *p <= '9'; ++p) pid = pid * 10 + (*p - '0');
+    if (p > entry->d_name && *p == '\0' && pid > 0) pids.push_back(pid);
+  }
+  closedir(directory);
+  return pids;
+}
+
+void BM_PidsReaddir(benchmark::State& state) {
+  std::string const root = Root(state.range(0));
+  size_t pids{0};
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    pids = ReaddirPids(root).size();
+  }
+  SetCounters(state, pids, allocations);
+}
+BENCHMARK(BM_PidsReaddir)->Arg(0)->Arg(100000);
+
+// The current listing, into a vector reused across frames as System does.
+void BM_PidsGetdents(benchmark::State& state) {
+  DirectorySource const source(Root(state.range(0)));
+  std::vector<int> pids;
+  source.Pids(pids);
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    source.Pids(pids);
+    benchmark::DoNotOptimize(pids.data());
+  }
+  SetCounters(state, pids.size(), allocations);
+}
+BENCHMARK(BM_PidsGetdents)->Arg(0)->Arg(100000);
+
+}  // namespace
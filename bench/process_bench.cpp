@@ -0,0 +1,229 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_support.h"
+#include "linux_parser.h"
+#include "process.h"
+#include "process_tree.h"
+#include "system.h"
+
+// Per-PID and per-frame cost of collecting the process table, comparing the
+// one-call-per-field parser path against the single-pass snapshot reader.
+// The last argument of most benchmarks picks the tree: 0 for the live /proc,
+// Bench::kSynthetic for an in-memory one with that many PIDs.
+
+namespace {
+
+using Bench::SetAllocationCounter;
+using Bench::SetPerPidCounters;
+
+void BM_Pids(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  size_t pids{0};
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    pids = LinuxParser::Pids().size();
+  }
+  SetAllocationCounter(state, allocations);
+  SetPerPidCounters(state, pids);
+}
+BENCHMARK(BM_Pids)->Arg(0)->Arg(Bench::kSynthetic);
+
+// The per-field sequence Process(pid) and System::Processes() used to run.
+void LegacyCollect(int pid) {
+  if (LinuxParser::Ram(pid).empty()) return;
+  benchmark::DoNotOptimize(LinuxParser::Command(pid));
+  benchmark::DoNotOptimize(LinuxParser::Ram(pid));
+  benchmark::DoNotOptimize(LinuxParser::UpTime(pid));
+  benchmark::DoNotOptimize(LinuxParser::User(pid));
+  benchmark::DoNotOptimize(LinuxParser::UpTime());
+  benchmark::DoNotOptimize(LinuxParser::ActiveJiffies(pid));
+}
+
+void BM_LegacyPerPid(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  std::vector<int> const pids = LinuxParser::Pids();
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    for (int pid : pids) LegacyCollect(pid);
+  }
+  SetAllocationCounter(state, allocations);
+  SetPerPidCounters(state, pids.size());
+}
+BENCHMARK(BM_LegacyPerPid)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(0)
+    ->Arg(Bench::kSynthetic);
+
+// The stat and status parsers as System::Processes() runs them.
+void BM_SnapshotPerPid(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  std::vector<int> const pids = LinuxParser::Pids();
+  LinuxParser::ProcessSnapshot snapshot;
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    for (int pid : pids) {
+      benchmark::DoNotOptimize(LinuxParser::ReadProcessSnapshot(pid, snapshot));
+    }
+  }
+  SetAllocationCounter(state, allocations);
+  SetPerPidCounters(state, pids.size());
+}
+BENCHMARK(BM_SnapshotPerPid)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(0)
+    ->Arg(Bench::kSynthetic);
+
+// Status read plus passwd lookup per PID; the cached path is in user_bench.
+void BM_UserPerPid(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  std::vector<int> const pids = LinuxParser::Pids();
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    for (int pid : pids) benchmark::DoNotOptimize(LinuxParser::User(pid));
+  }
+  SetAllocationCounter(state, allocations);
+  SetPerPidCounters(state, pids.size());
+}
+BENCHMARK(BM_UserPerPid)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(0)
+    ->Arg(Bench::kSynthetic);
+
+// A stat line whose comm contains spaces and parentheses.
+char const kStatLine[] =
+    "4242 (tmux: server (x)) S 1 4242 4242 0 -1 4194560 1208 0 0 0 123 45 6 7 "
+    "20 0 1 0 987654 12345678 2345 18446744073709551615 1 1 0 0 0 0 0 4096 "
+    "84483 0 0 0 17 3 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+
+void BM_StatParseIstringstream(benchmark::State& state) {
+  std::string const line{kStatLine};
+  for (auto _ : state) {
+    std::istringstream stream(line.substr(line.rfind(')') + 2));
+    std::vector<std::string> values;
+    std::string value;
+    while (stream >> value) values.push_back(value);
+    benchmark::DoNotOptimize(std::stol(values[11]) + std::stol(values[19]));
+  }
+}
+BENCHMARK(BM_StatParseIstringstream);
+
+void BM_StatParseFixedFields(benchmark::State& state) {
+  LinuxParser::ProcStat stat;
+  for (auto _ : state) {
+    LinuxParser::ParseProcStat(kStatLine, sizeof(kStatLine) - 1, stat);
+    benchmark::DoNotOptimize(stat.utime + stat.start_time);
+  }
+}
+BENCHMARK(BM_StatParseFixedFields);
+
+void BM_LegacyFrame(benchmark::State& state) {
+  for (auto _ : state) {
+    for (int pid : LinuxParser::Pids()) LegacyCollect(pid);
+  }
+}
+BENCHMARK(BM_LegacyFrame)->Unit(benchmark::kMillisecond);
+
+// One whole frame: Update() plus the top 10 by CPU. Arguments: scan pool
+// size and tree. Allocations are per frame once the table is warm.
+void BM_SystemProcessesFrame(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(1));
+  size_t const pids = LinuxParser::Pids().size();
+  System system(state.range(0));
+  system.Update();
+  system.Processes(SortKey::kCpu, 10);
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    system.Update();
+    benchmark::DoNotOptimize(system.Processes(SortKey::kCpu, 10).data());
+  }
+  SetAllocationCounter(state, allocations);
+  SetPerPidCounters(state, pids);
+}
+BENCHMARK(BM_SystemProcessesFrame)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->ArgsProduct({{1, 2, 4, 8}, {0, Bench::kSynthetic}});
+
+// A frame plus the threads of its 10 rows, as --threads=10 collects it;
+// the difference from BM_SystemProcessesFrame/1 is the thread scan.
+void BM_SystemThreadsFrame(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  System system(1);
+  system.Update();
+  system.Processes(SortKey::kCpu, 10);
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    system.Update();
+    for (Process const* process : system.Processes(SortKey::kCpu, 10)) {
+      benchmark::DoNotOptimize(system.Threads(process->Pid()));
+    }
+  }
+  SetAllocationCounter(state, allocations);
+}
+BENCHMARK(BM_SystemThreadsFrame)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->Arg(0)
+    ->Arg(Bench::kSynthetic);
+
+// A frame plus the cgroup table of its processes, as --cgroups collects it.
+// The synthetic tree has one leaf cgroup per 20 PIDs, each read once per
+// frame; the difference from BM_SystemProcessesFrame/1 is the cgroup pass.
+void BM_SystemCgroupsFrame(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  System system(1);
+  system.Update();
+  system.Processes(SortKey::kCpu, 10);
+  system.Cgroups(SortKey::kCpu, 10);
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    system.Update();
+    benchmark::DoNotOptimize(system.Processes(SortKey::kCpu, 10).data());
+    benchmark::DoNotOptimize(system.Cgroups(SortKey::kCpu, 10).data());
+  }
+  SetAllocationCounter(state, allocations);
+}
+BENCHMARK(BM_SystemCgroupsFrame)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->Arg(0)
+    ->Arg(Bench::kSynthetic);
+
+// The tree rollup alone, over the whole table, listing 10 rows.
+void BM_ProcessTreeBuild(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  System system(1);
+  system.Update();
+  std::vector<Process const*> const processes = system.Processes();
+  ProcessTree tree;
+  tree.Build(processes, 10);
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    tree.Build(processes, 10);
+    benchmark::DoNotOptimize(tree.Rows().data());
+  }
+  SetAllocationCounter(state, allocations);
+  SetPerPidCounters(state, processes.size());
+}
+BENCHMARK(BM_ProcessTreeBuild)->Arg(0)->Arg(Bench::kSynthetic);
+
+// Memory detail off and on: the smaps_rollup reads for the top 10 rows on
+// top of an otherwise identical frame.
+void BM_SystemProcessesMemoryDetail(benchmark::State& state) {
+  System system;
+  system.SetMemoryDetail(state.range(0) != 0);
+  for (auto _ : state) {
+    system.Update();
+    benchmark::DoNotOptimize(system.Processes(SortKey::kMemory, 10).data());
+  }
+}
+BENCHMARK(BM_SystemProcessesMemoryDetail)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(0)
+    ->Arg(1);
+
+}  // namespace
@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include <curses.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "bench_support.h"
+#include "collector.h"
+#include "format.h"
+#include "ncurses_display.h"
+#include "system.h"
+
+// The renderer's formatting: the field formatters on their own, and a whole
+// frame composed into DiffWindows on a terminal that writes to /dev/null.
+// Allocations per frame should stay at zero once the windows are warm.
+
+namespace {
+
+void BM_FormatElapsedTimeString(benchmark::State& state) {
+  long seconds{0};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Format::ElapsedTime(seconds));
+    seconds += 3727;
+  }
+}
+BENCHMARK(BM_FormatElapsedTimeString);
+
+void BM_FormatElapsedTimeBuffer(benchmark::State& state) {
+  char field[64];
+  long seconds{0};
+  for (auto _ : state) {
+    Format::ElapsedTime(seconds, field, sizeof(field));
+    benchmark::DoNotOptimize(field);
+    seconds += 3727;
+  }
+}
+BENCHMARK(BM_FormatElapsedTimeBuffer);
+
+void BM_FormatBytes(benchmark::State& state) {
+  char field[64];
+  double bytes{1};
+  for (auto _ : state) {
+    Format::Bytes(bytes, field, sizeof(field));
+    benchmark::DoNotOptimize(field);
+    bytes = bytes < 1e15 ? bytes * 3.7 : 1;
+  }
+}
+BENCHMARK(BM_FormatBytes);
+
+void BM_ProgressBar(benchmark::State& state) {
+  char bar[NCursesDisplay::kProgressBarSize + 1];
+  float percent{0};
+  for (auto _ : state) {
+    NCursesDisplay::ProgressBar(percent, bar);
+    benchmark::DoNotOptimize(bar);
+    percent = percent < 1 ? percent + 0.01f : 0;
+  }
+}
+BENCHMARK(BM_ProgressBar);
+
+// Alternates between two collected frames so every iteration has changes
+// to draw. Arguments: process rows and tree.
+void BM_RenderFrame(benchmark::State& state) {
+  int const rows = int(state.range(0));
+  std::shared_ptr<Frame> frames[2];
+  {
+    Bench::ScopedSource source(state.range(1));
+    System system;
+    Collector collector(system, std::chrono::milliseconds(1), rows);
+    collector.Sample();
+    frames[0] = collector.Sample();
+    frames[1] = collector.Sample();
+  }
+  std::FILE* null = std::fopen("/dev/null", "r+");
+  SCREEN* screen = newterm("xterm", null, null);
+  if (screen == nullptr) {
+    state.SkipWithError("no xterm terminfo entry");
+    std::fclose(null);
+    return;
+  }
+  int const width{140};
+  int const cores{int(frames[0]->core_utilization.size())};
+  WINDOW* system_window = newwin(14, width, 0, 0);
+  WINDOW* core_window =
+      newwin(2 + NCursesDisplay::CoreGridRows(cores, width), width, 0, 0);
+  WINDOW* process_window = newwin(3 + rows, width, 0, 0);
+  DiffWindow system(system_window);
+  DiffWindow core(core_window);
+  DiffWindow processes(process_window);
+
+  size_t const allocations = Bench::Allocations();
+  size_t drawn{0};
+  for (auto _ : state) {
+    Frame const& frame = *frames[drawn++ % 2];
+    NCursesDisplay::DisplaySystem(frame, system, 0);
+    NCursesDisplay::DisplayCores(frame, core);
+    NCursesDisplay::DisplayProcesses(frame.processes, SortKey::kCpu,
+                                     processes, rows, true, false);
+  }
+  Bench::SetAllocationCounter(state, allocations);
+
+  delwin(process_window);
+  delwin(core_window);
+  delwin(system_window);
+  endwin();
+  delscreen(screen);
+  std::fclose(null);
+}
+BENCHMARK(BM_RenderFrame)
+    ->ArgsProduct({{10, 50}, {0, Bench::kSynthetic}});
+
+}  // namespace
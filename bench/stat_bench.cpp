@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_support.h"
+#include "linux_parser.h"
+#include "processor.h"
+
+// System-wide /proc/stat collection: the per-value readers against one
+// SystemStatSnapshot read per frame. /proc/meminfo: an istringstream per
+// line against the key table. /proc/diskstats and /proc/net/dev: one read
+// and fixed-field parse each.
+
+namespace {
+
+void BM_SystemStatPerValueReads(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::Jiffies());
+    benchmark::DoNotOptimize(LinuxParser::ActiveJiffies());
+    benchmark::DoNotOptimize(LinuxParser::IdleJiffies());
+    benchmark::DoNotOptimize(LinuxParser::TotalProcesses());
+    benchmark::DoNotOptimize(LinuxParser::RunningProcesses());
+  }
+}
+BENCHMARK(BM_SystemStatPerValueReads);
+
+void BM_SystemStatSnapshot(benchmark::State& state) {
+  LinuxParser::SystemStatSnapshot snapshot;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::ReadSystemStat(snapshot));
+  }
+}
+BENCHMARK(BM_SystemStatSnapshot);
+
+// CPU utilization the legacy way (a string per field of the aggregate line)
+// and as System::Update() computes it for every line. Argument: tree.
+void BM_CpuUtilizationStrings(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::CpuUtilization());
+  }
+  Bench::SetAllocationCounter(state, allocations);
+}
+BENCHMARK(BM_CpuUtilizationStrings)->Arg(0)->Arg(Bench::kSynthetic);
+
+void BM_CpuUtilizationProcessor(benchmark::State& state) {
+  Bench::ScopedSource source(state.range(0));
+  LinuxParser::SystemStatSnapshot snapshot;
+  Processor processor;
+  size_t const allocations = Bench::Allocations();
+  for (auto _ : state) {
+    LinuxParser::ReadSystemStat(snapshot);
+    processor.Update(snapshot.cpus);
+    benchmark::DoNotOptimize(processor.Utilization());
+  }
+  Bench::SetAllocationCounter(state, allocations);
+}
+BENCHMARK(BM_CpuUtilizationProcessor)->Arg(0)->Arg(Bench::kSynthetic);
+
+void BM_MemInfoStreams(benchmark::State& state) {
+  for (auto _ : state) {
+    LinuxParser::MemInfo memory;
+    std::ifstream stream(LinuxParser::kProcDirectory +
+                         LinuxParser::kMeminfoFilename);
+    std::string line;
+    while (std::getline(stream, line)) {
+      std::istringstream line_stream(line);
+      std::string key;
+      unsigned long long value{0};
+      line_stream >> key >> value;
+      if (key == "MemTotal:") memory.total = value;
+      else if (key == "MemFree:") memory.free = value;
+      else if (key == "MemAvailable:") memory.available = value;
+      else if (key == "Buffers:") memory.buffers = value;
+      else if (key == "Cached:") memory.cached = value;
+      else if (key == "SwapTotal:") memory.swap_total = value;
+      else if (key == "SwapFree:") memory.swap_free = value;
+    }
+    benchmark::DoNotOptimize(memory);
+  }
+}
+BENCHMARK(BM_MemInfoStreams);
+
+void BM_MemInfoKeyTable(benchmark::State& state) {
+  LinuxParser::MemInfo memory;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::ReadMemInfo(memory));
+  }
+}
+BENCHMARK(BM_MemInfoKeyTable);
+
+void BM_DiskStats(benchmark::State& state) {
+  std::vector<LinuxParser::DiskStats> disks;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::ReadDiskStats(disks));
+  }
+}
+BENCHMARK(BM_DiskStats);
+
+void BM_NetDev(benchmark::State& state) {
+  std::vector<LinuxParser::NetDevStats> interfaces;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LinuxParser::ReadNetDev(interfaces));
+  }
+}
+BENCHMARK(BM_NetDev);
+
+}  // namespace
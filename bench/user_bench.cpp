@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "linux_parser.h"
+#include "user_cache.h"
+
+// UID to name resolution: a full passwd scan per lookup versus UserCache.
+
+namespace {
+
+std::string ScanPasswd(std::string const& uid) {
+  std::ifstream filestream(LinuxParser::kPasswordPath);
+  std::string line, user, password, line_uid;
+  while (std::getline(filestream, line)) {
+    std::istringstream fields(line);
+    std::getline(fields, user, ':');
+    std::getline(fields, password, ':');
+    std::getline(fields, line_uid, ':');
+    if (line_uid == uid) return user;
+  }
+  return {};
+}
+
+void BM_UserPasswdScan(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ScanPasswd("65534"));
+  }
+}
+BENCHMARK(BM_UserPasswdScan);
+
+void BM_UserCacheLookup(benchmark::State& state) {
+  UserCache users;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(users.Name(65534).data());
+  }
+}
+BENCHMARK(BM_UserCacheLookup);
+
+void BM_UserCacheRefresh(benchmark::State& state) {
+  UserCache users;
+  for (auto _ : state) {
+    users.Refresh();
+  }
+}
+BENCHMARK(BM_UserCacheRefresh);
+
+}  // namespace
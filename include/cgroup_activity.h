@@ -0,0 +1,57 @@
+#ifndef CGROUP_ACTIVITY_H
+#define CGROUP_ACTIVITY_H
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "linux_parser.h"
+
+// Activity of one cgroup, including its descendants, over the last interval.
+struct CgroupRate {
+  std::string path;          // as in /proc/<pid>/cgroup
+  int processes{0};          // listed processes in it or below it
+  float cpu_utilization{0};  // share of all CPUs
+  long long memory_bytes{-1};  // -1 without the memory controller
+  double read_bytes{-1};       // per second; -1 without the io controller
+  double write_bytes{-1};
+};
+
+/*
+Cgroup v2 accounting for the cgroups that hold processes, and their
+ancestors (systemd slices, pods).
+Each frame the processes are counted into their cgroups with Add(); Update()
+then reads each of those cgroups' files once, however many processes it
+holds, and rates are the deltas against the same cgroup's previous frame,
+over the time between those two reads.
+*/
+class CgroupActivity {
+ public:
+  // Start counting the processes of a new frame.
+  void Begin();
+  // Count one process in the cgroup at path.
+  void Add(std::string const& path);
+  // Read the cgroups counted since Begin() and their ancestors.
+  void Update(int cpus);
+  // One entry per cgroup read by the last Update(), in no fixed order.
+  std::vector<CgroupRate> const& Cgroups() const;
+
+ private:
+  struct Entry {
+    unsigned long frame{0};       // last frame counted in
+    int direct{0};                // processes directly in it that frame
+    int processes{0};             // including descendants
+    unsigned long read_frame{0};  // frame stats were read in
+    std::chrono::steady_clock::time_point read_at;  // just before that
+    LinuxParser::CgroupStats stats;
+  };
+  std::unordered_map<std::string, Entry> entries_;
+  std::vector<std::pair<std::string const*, int>> leaves_;
+  std::string ancestor_;
+  std::vector<CgroupRate> cgroups_;
+  unsigned long frame_{0};
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include "frame.h"
+#include "system.h"
+
+/*
+Samples the system on a background thread at a fixed monotonic interval
+and publishes each result as an immutable Frame. Readers pick up the most
+recent complete frame with Latest(), which never waits for collection.
+*/
+class Collector {
+ public:
+  Collector(System& system, std::chrono::milliseconds interval, int rows);
+  ~Collector();
+  void Start();
+  void Stop();
+  std::shared_ptr<Frame const> Latest() const;
+  // Called on the collector thread with every frame before it is
+  // published. Set before Start().
+  void OnFrame(std::function<void(Frame const&)> observer);
+  // Order used for the process rows of frames collected from now on.
+  void SetSortKey(SortKey key);
+  // Threads are read for the first rows processes of every frame, and for
+  // the processes expanded with ToggleThreads() while they are listed.
+  void SetThreadRows(int rows);
+  void ToggleThreads(int pid);
+  // Also collect the cgroups of the processes, as many as process rows.
+  void SetCgroups(bool enabled);
+  // Collect one frame on the calling thread. The first call also takes a
+  // baseline and waits a moment, so that its rates cover that moment
+  // rather than the time since boot.
+  std::shared_ptr<Frame> Sample();
+  // Collect count frames (0 for no limit, until Stop()) on the calling
+  // thread, on the same schedule as the background thread. Without an
+  // earlier Sample() a baseline is taken first, so the first frame covers
+  // a full interval.
+  void Collect(unsigned long count,
+               std::function<void(std::shared_ptr<Frame>)> const& sink);
+
+ private:
+  void Run();
+  // Sample once and throw the frame away, leaving sequence numbers and
+  // history as they were.
+  void Prime();
+
+  System& system_;
+  std::chrono::milliseconds interval_;
+  int rows_;
+  std::atomic<SortKey> sort_key_{SortKey::kCpu};
+  std::atomic<int> thread_rows_{0};
+  std::atomic<bool> cgroups_{false};
+  std::mutex expanded_mutex_;
+  std::unordered_set<int> expanded_;
+  std::string operating_system_;
+  std::string kernel_;
+  bool primed_{false};
+  unsigned long sequence_{0};
+  Frame::History cpu_history_;
+  Frame::History memory_history_;
+  std::shared_ptr<Frame const> latest_;
+  std::function<void(Frame const&)> observer_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_{false};
+};
+
+#endif
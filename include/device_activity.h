@@ -0,0 +1,53 @@
+#ifndef DEVICE_ACTIVITY_H
+#define DEVICE_ACTIVITY_H
+
+#include <string>
+#include <vector>
+
+#include "linux_parser.h"
+
+// Per-second activity of one block device over the last interval.
+struct DiskRate {
+  std::string name;
+  double reads{0};        // completed per second
+  double writes{0};
+  double read_bytes{0};   // per second
+  double write_bytes{0};
+  float utilization{0};   // share of the interval with I/O in flight
+};
+
+// Per-second traffic of one network interface over the last interval.
+struct NetRate {
+  std::string name;
+  double rx_bytes{0};
+  double tx_bytes{0};
+  double rx_packets{0};
+  double tx_packets{0};
+};
+
+/*
+Disk and network throughput.
+Fed with one /proc/diskstats and one /proc/net/dev read per frame, each
+on its own so that one file missing does not stop the other; rates are the
+deltas against the previous sample of the same device, matched by name, so
+devices that come and go do not disturb the others.
+*/
+class DeviceActivity {
+ public:
+  std::vector<DiskRate> const& Disks() const;
+  std::vector<NetRate> const& Interfaces() const;
+  // seconds is the time since the previous call, or 0 on the first.
+  void UpdateDisks(std::vector<LinuxParser::DiskStats> const& disks,
+                   double seconds);
+  void UpdateInterfaces(
+      std::vector<LinuxParser::NetDevStats> const& interfaces,
+      double seconds);
+
+ private:
+  std::vector<LinuxParser::DiskStats> prev_disks_;
+  std::vector<LinuxParser::NetDevStats> prev_interfaces_;
+  std::vector<DiskRate> disks_;
+  std::vector<NetRate> interfaces_;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef DIFF_WINDOW_H
+#define DIFF_WINDOW_H
+
+#include <curses.h>
+
+#include <vector>
+
+/*
+Row-at-a-time drawing into an ncurses window that only touches cells which
+changed since the last frame. Each row is composed into a reused buffer of
+chtype cells (character plus attributes), compared with what was drawn
+there before, and only the changed span is written to the window.
+*/
+class DiffWindow {
+ public:
+  explicit DiffWindow(WINDOW* window);
+
+  WINDOW* Window() const;
+  int Width() const;
+  // Start composing row: the scratch row is reset to blanks.
+  void BeginRow(int row);
+  // Place text at column of the row being composed, clipped to the border.
+  void Put(int column, char const* text, chtype attributes = A_NORMAL);
+  // Compare the composed row with the previous frame and draw the change.
+  void EndRow();
+
+ private:
+  WINDOW* window_;
+  int width_;  // inside the border
+  int row_{0};
+  std::vector<chtype> scratch_;
+  std::vector<chtype> drawn_;  // rows x width_ cells last written
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <cstdio>
+#include <string>
+
+#include "frame.h"
+
+/*
+Serializes frames for headless use, one JSON object per line or CSV rows
+(one per process row, with the system columns repeated). Each frame is
+formatted into a reused buffer and written with a single fwrite.
+*/
+class Exporter {
+ public:
+  enum class Format { kJsonLines, kCsv };
+
+  Exporter(std::FILE* out, Format format);
+  void Write(Frame const& frame);
+
+ private:
+  void AppendJson(Frame const& frame);
+  void AppendCsv(Frame const& frame);
+  void AppendNumber(long long value);
+  void AppendNumber(double value, int precision);
+  void AppendJsonString(std::string const& value);
+  void AppendCsvString(std::string const& value);
+
+  std::FILE* out_;
+  Format format_;
+  bool wrote_header_{false};
+  std::string buffer_;
+};
+
+#endif
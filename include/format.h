@@ -1,10 +1,15 @@
 #ifndef FORMAT_H
 #define FORMAT_H
 
+#include <cstddef>
 #include <string>
 
 namespace Format {
 std::string ElapsedTime(long times);  // TODO: See src/format.cpp
+// Same format written into out, for callers that reuse a buffer.
+void ElapsedTime(long times, char* out, std::size_t size);
+// A byte count with a K, M, G or T suffix (powers of 1024) into out.
+void Bytes(double bytes, char* out, std::size_t size);
 };                                    // namespace Format
 
 #endif
\ No newline at end of file
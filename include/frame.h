@@ -0,0 +1,80 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "cgroup_activity.h"
+#include "device_activity.h"
+#include "linux_parser.h"
+#include "proc_events.h"
+#include "process.h"
+#include "ring_buffer.h"
+
+/*
+One complete sample of everything the display shows. Frames are built by
+the Collector and never modified once published, so the renderer can read
+one while the next is being collected.
+*/
+struct ProcessRow {
+  int pid{0};
+  std::string user;
+  std::string command;
+  float cpu_utilization{0.0f};
+  unsigned long cpu_ticks{0};  // during the interval
+  long ram{0};     // MB, resident
+  long uptime{0};  // seconds
+  Process::CpuHistory cpu_history;
+  long pss{-1};   // MB, only read in memory detail mode; -1 if unknown
+  long swap{-1};  // MB, as pss
+  double read_rate{0};   // disk bytes/s; -1 if io is not readable
+  double write_rate{0};  // as read_rate
+  // Only for processes whose threads were asked for; busiest first.
+  std::vector<Process::Thread> threads{};
+  // Tree order (SortKey::kTree) only: nesting depth, and the row's figures
+  // summed over its whole subtree.
+  int depth{0};
+  unsigned long tree_ticks{0};
+  float tree_cpu_utilization{0.0f};
+  long tree_ram{0};  // MB
+};
+
+struct Frame {
+  // System-wide samples kept for the history graphs.
+  using History = RingBuffer<float, 240>;
+
+  unsigned long sequence{0};
+  std::string operating_system;
+  std::string kernel;
+  float cpu_utilization{0.0f};
+  std::vector<float> core_utilization;
+  // Jiffies per cpu line over the interval ([0] aggregate, [n + 1] cpuN),
+  // from which the utilization figures are derived.
+  std::vector<LinuxParser::CpuTimes> cpu_deltas;
+  float memory_utilization{0.0f};  // excluding reclaimable cache
+  float swap_utilization{0.0f};
+  float cache_utilization{0.0f};  // buffers and page cache
+  History cpu_history;  // up to and including this frame
+  History memory_history;
+  std::vector<DiskRate> disks;
+  std::vector<NetRate> interfaces;
+  int total_processes{0};
+  int running_processes{0};
+  ProcEventCounts process_events;  // inactive unless events are watched
+  long uptime{0};
+  SortKey sort_key{SortKey::kCpu};
+  bool memory_detail{false};  // rows carry pss and swap
+  std::vector<ProcessRow> processes;  // top rows in sort_key order
+  // Only when cgroups are collected; top rows in sort_key order.
+  std::vector<CgroupRate> cgroups;
+
+  // How long the sample took to collect, and how late it started relative
+  // to its slot on the sampling schedule.
+  std::chrono::steady_clock::time_point sampled_at;
+  std::chrono::system_clock::time_point wall_time;
+  std::chrono::steady_clock::duration collection_time{};
+  std::chrono::steady_clock::duration jitter{};
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "frame.h"
+
+/*
+Fixed-size, memory-mapped ring of recorded frames.
+
+The file holds a header, a table of interned user and command strings, and
+a ring of fixed-size record slots. A record stores one frame's per-CPU
+jiffies deltas for the interval, the system counters and the top process
+rows as varints, with strings replaced by table indexes; utilization is
+recomputed from the deltas on replay. Once the string table is full, new
+strings are stored inline in the records that use them, so a busy host
+with many distinct commands never invalidates what was recorded. The file
+size never changes after Open().
+*/
+class HistoryWriter {
+ public:
+  HistoryWriter() = default;
+  ~HistoryWriter();
+  HistoryWriter(HistoryWriter const&) = delete;
+  HistoryWriter& operator=(HistoryWriter const&) = delete;
+
+  // Create or truncate path with room for frames records of up to rows
+  // process rows each.
+  bool Open(std::string const& path, std::size_t frames, std::size_t rows);
+  bool Record(Frame const& frame);
+
+ private:
+  // The table id of key, adding it if needed; the table size when full.
+  std::uint32_t Intern(std::string const& key);
+
+  std::uint8_t* map_{nullptr};
+  std::size_t size_{0};
+  std::size_t rows_{0};
+  std::unordered_map<std::string, std::uint32_t> strings_;
+  std::string key_;  // the truncated string being looked up
+};
+
+class HistoryReader {
+ public:
+  HistoryReader() = default;
+  ~HistoryReader();
+  HistoryReader(HistoryReader const&) = delete;
+  HistoryReader& operator=(HistoryReader const&) = delete;
+
+  bool Open(std::string const& path);
+  // Number of frames that can be replayed, oldest first.
+  std::size_t Frames() const;
+  // The frame at index, counted against the frames written when called, so
+  // indexes shift while a recorder is still running. nullptr when the
+  // recorder overwrote the slot meanwhile.
+  std::shared_ptr<Frame> Read(std::size_t index) const;
+
+ private:
+  std::uint8_t const* map_{nullptr};
+  std::size_t size_{0};
+};
+
+#endif
@@ -1,31 +1,125 @@
 #ifndef SYSTEM_PARSER_H
 #define SYSTEM_PARSER_H
 
+#include <sys/types.h>
+
+#include <cstddef>
 #include <fstream>
 #include <regex>
 #include <string>
+#include <vector>
+
+#include "proc_source.h"
 
 namespace LinuxParser {
+// Every /proc read below goes through the current source, the live /proc
+// unless replaced. The source must outlive its use; set it before starting
+// any collection.
+void SetSource(ProcSource const& source);
+ProcSource const& Source();
+// Likewise for the cgroup v2 filesystem: /sys/fs/cgroup, or
+// /sys/fs/cgroup/unified on hosts that mount v1 controllers there.
+void SetCgroupSource(ProcSource const& source);
+ProcSource const& CgroupSource();
+
 // Paths
 const std::string kProcDirectory{"/proc/"};
 const std::string kCmdlineFilename{"/cmdline"};
 const std::string kCpuinfoFilename{"/cpuinfo"};
 const std::string kStatusFilename{"/status"};
 const std::string kStatFilename{"/stat"};
+const std::string kStatmFilename{"/statm"};
+const std::string kIoFilename{"/io"};
+const std::string kSmapsRollupFilename{"/smaps_rollup"};
 const std::string kUptimeFilename{"/uptime"};
 const std::string kMeminfoFilename{"/meminfo"};
 const std::string kVersionFilename{"/version"};
+const std::string kDiskstatsFilename{"/diskstats"};
+const std::string kNetDevFilename{"/net/dev"};
+const std::string kCgroupFilename{"/cgroup"};
+const std::string kCgroupRoot{"/sys/fs/cgroup"};
+const std::string kCgroupHybridRoot{"/sys/fs/cgroup/unified"};
 const std::string kOSPath{"/etc/os-release"};
 const std::string kPasswordPath{"/etc/passwd"};
 
 // System
+// The /proc/meminfo fields the monitor uses, in kB (HugePages_* are counts).
+struct MemInfo {
+  unsigned long long total{0};
+  unsigned long long free{0};
+  unsigned long long available{0};
+  unsigned long long buffers{0};
+  unsigned long long cached{0};
+  unsigned long long swap_total{0};
+  unsigned long long swap_free{0};
+  unsigned long long dirty{0};
+  unsigned long long shmem{0};
+  unsigned long long slab{0};
+  unsigned long long huge_pages_total{0};
+  unsigned long long huge_pages_free{0};
+  unsigned long long huge_page_size{0};
+  // Used memory excludes whatever the kernel could reclaim on demand, so a
+  // full page cache does not read as memory pressure.
+  unsigned long long Used() const {
+    return available < total ? total - available : 0;
+  }
+  unsigned long long SwapUsed() const {
+    return swap_free < swap_total ? swap_total - swap_free : 0;
+  }
+  float Utilization() const { return Fraction(Used(), total); }
+  float SwapUtilization() const { return Fraction(SwapUsed(), swap_total); }
+  float CacheUtilization() const {
+    return Fraction(buffers + cached, total);
+  }
+
+ private:
+  static float Fraction(unsigned long long part, unsigned long long whole) {
+    return whole > 0 ? float(double(part) / double(whole)) : 0.0f;
+  }
+};
+bool ParseMemInfo(char const* buffer, std::size_t length, MemInfo& memory);
+bool ReadMemInfo(MemInfo& memory);
 float MemoryUtilization();
+
+// Cumulative counters of one block device line of /proc/diskstats.
+struct DiskStats {
+  char name[32]{};
+  unsigned long long reads{0};           // completed
+  unsigned long long sectors_read{0};    // 512-byte sectors
+  unsigned long long writes{0};          // completed
+  unsigned long long sectors_written{0};
+  unsigned long long io_ticks{0};        // ms with I/O in flight
+};
+// Devices that have never done any I/O (unused loop and ram devices) are
+// left out. Entries are reused, so a steady device list stops allocating.
+bool ParseDiskStats(char const* buffer, std::size_t length,
+                    std::vector<DiskStats>& disks);
+bool ReadDiskStats(std::vector<DiskStats>& disks);
+
+// Cumulative counters of one interface line of /proc/net/dev.
+struct NetDevStats {
+  char name[32]{};
+  unsigned long long rx_bytes{0};
+  unsigned long long rx_packets{0};
+  unsigned long long tx_bytes{0};
+  unsigned long long tx_packets{0};
+};
+// The loopback interface and interfaces that have never carried a byte are
+// left out.
+bool ParseNetDev(char const* buffer, std::size_t length,
+                 std::vector<NetDevStats>& interfaces);
+bool ReadNetDev(std::vector<NetDevStats>& interfaces);
 long UpTime();
 std::vector<int> Pids();
+// As Pids(), into pids, whose capacity is kept for the next frame.
+bool Pids(std::vector<int>& pids);
 int TotalProcesses();
 int RunningProcesses();
 std::string OperatingSystem();
 std::string Kernel();
+// Bytes the calling thread has passed to write(2) so far (wchar of
+// /proc/thread-self/io), or -1 if that is unavailable.
+long long ThreadWrittenBytes();
 
 // CPU
 enum CPUStates {
@@ -41,6 +135,31 @@ enum CPUStates {
   kGuestNice_
 };
 std::vector<std::string> CpuUtilization();
+// Cumulative jiffies of one "cpu" line of /proc/stat.
+struct CpuTimes {
+  long active{0};  // user + nice + system + irq + softirq + steal
+  long idle{0};    // idle + iowait
+  long Total() const { return active + idle; }
+};
+// cpus[0] is the aggregate line and cpus[n + 1] is cpuN.
+bool ParseCpuTimes(char const* buffer, std::size_t length,
+                   std::vector<CpuTimes>& cpus);
+
+// Everything the monitor uses from /proc/stat, taken from a single read so
+// all values within a frame agree with each other.
+struct SystemStatSnapshot {
+  std::vector<CpuTimes> cpus;  // as for ParseCpuTimes
+  unsigned long long interrupts{0};        // intr (total)
+  unsigned long long context_switches{0};  // ctxt
+  long boot_time{0};                       // btime, seconds since the epoch
+  long processes{0};                       // forks since boot
+  int procs_running{0};
+  int procs_blocked{0};
+};
+// Fields whose key is missing from buffer are set to 0.
+bool ParseSystemStat(char const* buffer, std::size_t length,
+                     SystemStatSnapshot& snapshot);
+bool ReadSystemStat(SystemStatSnapshot& snapshot);
 long Jiffies();
 long ActiveJiffies();
 long ActiveJiffies(int pid);
@@ -50,8 +169,90 @@ long IdleJiffies();
 std::string Command(int pid);
 std::string Ram(int pid);
 std::string Uid(int pid);
-std::string User(int pid);
+std::string User(int pid);  // "" if the process is gone
+std::string UserName(uid_t uid);  // safe from any thread
 long int UpTime(int pid);
+
+// The /proc/<pid>/stat fields the monitor uses, parsed in place from a stack
+// buffer with no heap allocation.
+struct ProcStat {
+  char comm[64];
+  char state;
+  int ppid;
+  unsigned long utime;
+  unsigned long stime;
+  long cutime;
+  long cstime;
+  long num_threads;
+  unsigned long long start_time;  // clock ticks after boot
+  unsigned long vsize;            // bytes
+  long rss;                       // pages
+};
+bool ParseProcStat(char const* buffer, std::size_t length, ProcStat& stat);
+bool ReadProcStat(int pid, ProcStat& stat);
+// Threads of a process: the IDs under /proc/<pid>/task, and the stat file of
+// one of them, which has the same layout as the process's with comm being
+// the thread name.
+bool Tasks(int pid, std::vector<int>& tids);
+bool ReadTaskStat(int pid, int tid, ProcStat& stat);
+
+// Everything the process table needs about one PID: the volatile stat fields
+// plus the identity fields from /status and /cmdline that never change.
+struct ProcessSnapshot {
+  int pid{0};
+  ProcStat stat{};
+  std::string command;
+  uid_t uid{0};
+};
+bool ReadProcessSnapshot(int pid, ProcessSnapshot& snapshot);
+bool ReadProcessIdentity(int pid, ProcessSnapshot& snapshot);
+
+// Storage I/O counters from /proc/<pid>/io, in bytes since the process
+// started. Only the process owner (or CAP_SYS_PTRACE) may read them; on
+// failure ReadProcIo returns false with errno set, EACCES when refused.
+struct ProcIo {
+  unsigned long long read_bytes{0};
+  unsigned long long write_bytes{0};
+};
+bool ParseProcIo(char const* buffer, std::size_t length, ProcIo& io);
+bool ReadProcIo(int pid, ProcIo& io);
+
+// Proportional memory from /proc/<pid>/smaps_rollup, in kB. The kernel walks
+// every mapping of the process to produce it, so it is much slower to read
+// than stat or statm.
+struct MemoryRollup {
+  unsigned long long rss{0};
+  unsigned long long pss{0};
+  unsigned long long swap{0};
+  unsigned long long swap_pss{0};
+};
+bool ParseMemoryRollup(char const* buffer, std::size_t length,
+                       MemoryRollup& rollup);
+bool ReadMemoryRollup(int pid, MemoryRollup& rollup);
+
+// Cgroup v2
+// The process's cgroup v2 path from the "0::" line of /proc/<pid>/cgroup,
+// as in "/system.slice/nginx.service"; false when it is only in v1
+// hierarchies.
+bool ParseProcessCgroup(char const* buffer, std::size_t length,
+                        std::string& path);
+bool ReadProcessCgroup(int pid, std::string& path);
+// Accounting files of one cgroup, cumulative over it and its descendants.
+// Controllers that are not enabled for the cgroup leave their fields unset.
+struct CgroupStats {
+  unsigned long long usage_usec{0};  // cpu.stat
+  long long memory_bytes{-1};        // memory.current
+  bool has_io{false};                // io.stat, summed over devices
+  unsigned long long read_bytes{0};
+  unsigned long long write_bytes{0};
+};
+bool ParseCgroupCpuStat(char const* buffer, std::size_t length,
+                        CgroupStats& stats);
+bool ParseCgroupIoStat(char const* buffer, std::size_t length,
+                       CgroupStats& stats);
+// Read the files of the cgroup at path (as from ReadProcessCgroup) from the
+// cgroup source; false if the cgroup is gone.
+bool ReadCgroupStats(std::string const& path, CgroupStats& stats);
 };  // namespace LinuxParser
 
 #endif
\ No newline at end of file
@@ -3,14 +3,67 @@
 
 #include <curses.h>
 
-#include "process.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "diff_window.h"
+#include "frame.h"
+#include "history.h"
 #include "system.h"
 
 namespace NCursesDisplay {
-void Display(System& system, int n = 10);
-void DisplaySystem(System& system, WINDOW* window);
-void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n);
-std::string ProgressBar(float percent);
+// history, if given, records every collected frame; cgroups starts in the
+// cgroup view.
+void Display(System& system, int n = 10,
+             std::chrono::milliseconds interval = std::chrono::seconds(1),
+             SortKey sort_key = SortKey::kCpu,
+             HistoryWriter* history = nullptr, bool cgroups = false);
+void Replay(HistoryReader const& history, int n = 10,
+            std::chrono::milliseconds interval = std::chrono::seconds(1));
+// terminal_bytes is what the previous frame cost on the terminal.
+void DisplaySystem(Frame const& frame, DiffWindow& window,
+                   std::size_t terminal_bytes);
+void DisplayCores(Frame const& frame, DiffWindow& window);
+// Rows of the core grid, at most 8; cores past the window's rows share the
+// last cell.
+int CoreGridRows(int cores, int width);
+// Disks on the left half, network interfaces on the right, one device per
+// row under a header row; devices past rows are not shown.
+void DisplayDevices(Frame const& frame, DiffWindow& window, int rows);
+int DeviceRows(Frame const& frame);
+// selected is the index of the highlighted process, or -1 for none.
+void DisplayProcesses(std::vector<ProcessRow> const& processes,
+                      SortKey sort_key, DiffWindow& window, int n,
+                      bool sparklines = false, bool memory_detail = false,
+                      int selected = -1);
+// The cgroups in the rows the process list would otherwise take; cgroups
+// are sorted by path for keys other than CPU, memory and I/O.
+void DisplayCgroups(std::vector<CgroupRate> const& cgroups, SortKey sort_key,
+                    DiffWindow& window, int n);
+// "0%", 50 bars and the value, as kProgressBarSize chars plus the NUL.
+int const kProgressBarSize{62};
+void ProgressBar(float percent, char* out);
+
+// Render the newest width samples of history (fractions 0-1) as one
+// character per sample into out, which must hold width + 1 chars. Shorter
+// histories are right-aligned.
+template <typename History>
+void Sparkline(History const& history, int width, char* out) {
+  static char const kLevels[] = " .:-=+*#%@";
+  int const levels = int(sizeof(kLevels)) - 2;
+  int const samples = std::min(width, int(history.Size()));
+  int const pad = width - samples;
+  for (int i = 0; i < pad; ++i) out[i] = ' ';
+  for (int i = 0; i < samples; ++i) {
+    float const value = history[history.Size() - samples + i];
+    float const clamped = std::min(std::max(value, 0.0f), 1.0f);
+    int const level = int(clamped * levels + 0.5f);
+    out[pad + i] = kLevels[level];
+  }
+  out[width] = '\0';
+}
 };  // namespace NCursesDisplay
 
 #endif
\ No newline at end of file
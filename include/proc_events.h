@@ -0,0 +1,70 @@
+#ifndef PROC_EVENTS_H
+#define PROC_EVENTS_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Process lifecycle events between two listings; threads are not counted.
+struct ProcEventCounts {
+  bool active{false};  // false when PIDs come from polling /proc
+  unsigned long forks{0};
+  unsigned long execs{0};
+  unsigned long exits{0};
+  // Processes that started and exited between two listings, so a scan of
+  // /proc never saw them.
+  unsigned long short_lived{0};
+};
+
+/*
+The live PID set, kept up to date by the kernel's process events (the
+netlink proc connector) instead of a /proc directory scan per frame.
+A listener thread applies fork and exit events as they arrive; Pids() hands
+the current set to the frame and starts a new interval of counts. When the
+socket overflows and events are lost, the next Pids() rescans /proc.
+*/
+class ProcEvents {
+ public:
+  ProcEvents() = default;
+  ~ProcEvents();
+  ProcEvents(ProcEvents const&) = delete;
+  ProcEvents& operator=(ProcEvents const&) = delete;
+
+  // Subscribe and seed the set from /proc. Returns false, with errno set,
+  // when the connector is unavailable, or the kernel is old enough to
+  // require CAP_NET_ADMIN; polling /proc is then the only source.
+  bool Start();
+  void Stop();
+  bool Active() const;
+  // Replace pids with the processes alive now, and counts with the events
+  // since the previous call. short_lived, when given, is replaced with the
+  // PIDs counted in counts.short_lived.
+  void Pids(std::vector<int>& pids, ProcEventCounts& counts,
+            std::vector<int>* short_lived = nullptr);
+  // A listed PID turned out to be gone; drop it unless it has been forked
+  // again since the listing.
+  void Forget(int pid);
+
+ private:
+  void Run();
+  // Apply the events in one datagram; mutex_ held.
+  void Apply(char const* data, size_t length);
+  void Resync();
+
+  int socket_{-1};
+  std::thread thread_;
+  std::atomic<bool> stopping_{false};
+  std::mutex mutex_;
+  // Each live PID with the listing it was forked after, 0 for those seeded
+  // from /proc; listing_ counts the Pids() calls.
+  std::unordered_map<int, unsigned long> live_;
+  unsigned long listing_{1};
+  ProcEventCounts counts_;
+  std::vector<int> short_lived_;  // their PIDs
+  bool lost_{false};  // events dropped since the last listing
+  std::vector<int> scan_;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef PROC_SOURCE_H
+#define PROC_SOURCE_H
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+Where LinuxParser reads /proc from. Paths are relative to the /proc root
+and start with '/', as in "/stat" or "/123/status".
+- DirectorySource reads a directory tree: the live /proc, or a copy of one
+  (for example a synthesized tree) under any root.
+- SnapshotSource serves files held in memory, loaded from a tar archive, so
+  repeated runs see exactly the same bytes.
+*/
+class ProcSource {
+ public:
+  virtual ~ProcSource() = default;
+  // Read up to capacity - 1 bytes of path into buffer and NUL-terminate it.
+  // Returns the number of bytes read, or -1 with errno set.
+  virtual ssize_t Read(char const* path, char* buffer,
+                       std::size_t capacity) const = 0;
+  // Read all of path into buffer, growing it as needed; the buffer keeps its
+  // capacity between calls. NUL-terminated; returns as above.
+  virtual ssize_t Read(char const* path, std::vector<char>& buffer) const = 0;
+  // Replace pids with the numeric entries of the root, in no fixed order.
+  virtual bool Pids(std::vector<int>& pids) const = 0;
+  // Replace tids with the thread IDs under "/<pid>/task", in no fixed order.
+  virtual bool Tasks(int pid, std::vector<int>& tids) const = 0;
+
+  // The running system's /proc.
+  static ProcSource const& Live();
+};
+
+class DirectorySource : public ProcSource {
+ public:
+  // root is the directory standing in for /proc, without a trailing '/'.
+  explicit DirectorySource(std::string root);
+  ssize_t Read(char const* path, char* buffer,
+               std::size_t capacity) const override;
+  ssize_t Read(char const* path, std::vector<char>& buffer) const override;
+  bool Pids(std::vector<int>& pids) const override;
+  bool Tasks(int pid, std::vector<int>& tids) const override;
+
+ private:
+  // Open root_ + path with flags; -1 if the joined path does not fit.
+  int Open(char const* path, int flags) const;
+  // The numeric directory entries of root_ + path.
+  bool List(char const* path, std::vector<int>& numbers) const;
+
+  std::string root_;
+};
+
+class SnapshotSource : public ProcSource {
+ public:
+  // Load the regular files of a tar archive (ustar) whose member names are
+  // relative to the /proc root; a leading "./" is ignored. Returns nullptr
+  // if the file cannot be read or is not a tar archive.
+  static std::unique_ptr<SnapshotSource> LoadTar(std::string const& path);
+
+  void Add(std::string path, std::string contents);
+  ssize_t Read(char const* path, char* buffer,
+               std::size_t capacity) const override;
+  ssize_t Read(char const* path, std::vector<char>& buffer) const override;
+  bool Pids(std::vector<int>& pids) const override;
+  bool Tasks(int pid, std::vector<int>& tids) const override;
+
+ private:
+  std::string const* Find(char const* path) const;
+
+  std::unordered_map<std::string, std::string> files_;
+  std::vector<int> pids_;
+  std::unordered_map<int, std::vector<int>> tasks_;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef PROC_SYNTH_H
+#define PROC_SYNTH_H
+
+#include <functional>
+#include <string>
+
+// Synthetic /proc trees for benchmarks and reproducible runs.
+namespace ProcSynth {
+// Receives each file of the tree by its path relative to the /proc root, as
+// SnapshotSource::Add() takes it; returns false to stop.
+using Sink =
+    std::function<bool(std::string const& path, std::string const& contents)>;
+
+// A machine with cpus CPUs and pids processes: about one in eight is a
+// kernel thread (no address space, no cmdline), the rest are spread over a
+// handful of commands and users. The same seed gives the same tree.
+bool Synthesize(Sink const& out, int pids, int cpus, unsigned seed);
+// The cgroup v2 hierarchy the processes of Synthesize() with the same pids
+// are placed in, relative to the /sys/fs/cgroup root: systemd services and
+// pod containers, with each parent's counters the sum of its children's.
+bool SynthesizeCgroups(Sink const& out, int pids, unsigned seed);
+};  // namespace ProcSynth
+
+#endif
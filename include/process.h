@@ -1,33 +1,116 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <chrono>
 #include <string>
+#include <vector>
+
+#include "linux_parser.h"
+#include "ring_buffer.h"
+
+// Orderings offered for the process list. kTree lists processes under
+// their parents, heaviest subtree first (see ProcessTree).
+enum class SortKey { kCpu, kMemory, kPid, kStartTime, kIo, kTree };
+
 /*
 Basic class for Process representation
 It contains relevant attributes as shown below
 */
 class Process {
  public:
+  // Recent CPU utilization samples kept per process for sparklines.
+  using CpuHistory = RingBuffer<float, 16>;
+  // One thread of the process as of the last RefreshThreads().
+  struct Thread {
+    int tid{0};
+    std::string name;  // comm, as set with prctl(PR_SET_NAME)
+    char state{0};
+    unsigned long ticks{0};  // utime + stime
+    float cpu_utilization{0.0f};
+  };
+
   Process(int pid);
+  // jiffies_delta is the system-wide jiffies elapsed since the previous
+  // frame, or 0 on the first frame when there is no interval yet.
+  Process(LinuxParser::ProcessSnapshot const& snapshot, std::string user,
+          long system_uptime, long jiffies_delta);
+  // Update only the fields that change between frames.
+  void Refresh(LinuxParser::ProcStat const& stat, long system_uptime,
+               long jiffies_delta);
   int Pid() const;
+  int PPid() const;  // as of the last Refresh(); changes on reparenting
   std::string User() const;
   std::string Command() const;
   float CpuUtilization() const;
+  // utime + stime ticks spent during the last interval
+  unsigned long CpuTicks() const;
+  CpuHistory const& CpuUtilizationHistory() const;
   std::string Ram() const;
+  long RamKb() const;  // resident set size
+  // Proportional set size and swapped-out memory, in kB, as of the last
+  // SetMemoryRollup(); -1 if never read or unreadable.
+  long PssKb() const;
+  long SwapKb() const;
+  void SetMemoryRollup(LinuxParser::MemoryRollup const& rollup);
+  void ClearMemoryRollup();
+  // Fold in this frame's /proc/<pid>/io counters; seconds is the time since
+  // the previous frame, or 0 on the first one.
+  void RefreshIo(LinuxParser::ProcIo const& io, double seconds);
+  // Stop reading io for this process: it was refused once and the answer
+  // does not change for the life of the process.
+  void DenyIo();
+  bool IoDenied() const;
+  // Disk bytes per second over the last interval; -1 when io is denied.
+  double ReadRate() const;
+  double WriteRate() const;
+  // Fold in freshly read threads (tid, name, state and ticks filled in);
+  // their CPU utilization is set and they replace Threads(). Threads are
+  // only read for some processes, so frame counts the calls to
+  // System::Update(): when the previous scan was not in the previous frame
+  // this one is only a baseline and every thread shows 0%.
+  void RefreshThreads(std::vector<Thread>& threads, long jiffies_delta,
+                      unsigned long frame);
+  // Ordered by thread ID.
+  std::vector<Thread> const& Threads() const;
+  // The cgroup v2 path. Processes are placed in their cgroup before they
+  // start running and rarely move afterwards, so it is read again only
+  // every 10 to 20 seconds, spread by PID so that not every process is
+  // read in the same frame.
+  bool CgroupStale(std::chrono::steady_clock::time_point now) const;
+  std::string const& Cgroup() const;  // empty when not in a v2 hierarchy
+  void SetCgroup(std::string const& path,
+                 std::chrono::steady_clock::time_point now);
   long int UpTime() const;
+  char State() const;
+  unsigned long long StartTime() const;
   bool operator<(Process const& a) const;
 
 // Declare any necessary private members
  private:
   int pid_;
-  long ram_;
+  int ppid_;
+  long ram_;     // MB, as shown
+  long ram_kb_;
+  long pss_kb_{-1};
+  long swap_kb_{-1};
+  bool io_denied_{false};
+  bool io_seen_{false};
+  LinuxParser::ProcIo prev_io_{};
+  double read_rate_{0};
+  double write_rate_{0};
   float cpu_utilization_;
   long uptime_;
+  char state_;
+  unsigned long prev_ticks_;  // utime + stime at the previous sample
+  unsigned long ticks_delta_;
+  CpuHistory cpu_history_;
+  std::vector<Thread> threads_;
+  unsigned long threads_frame_{0};  // frame of the last thread scan
+  std::chrono::steady_clock::time_point cgroup_read_at_{};  // {} if never
+  std::string cgroup_;
+  unsigned long long start_time_;
   std::string user_;
   std::string command_;
-
-
-
 };
 
 #endif
\ No newline at end of file
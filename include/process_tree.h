@@ -0,0 +1,53 @@
+#ifndef PROCESS_TREE_H
+#define PROCESS_TREE_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "process.h"
+
+/*
+The process table arranged by parent PID, with inclusive (subtree) CPU and
+memory for every process.
+Nodes are positions in the input array and all links are indices: each
+node's children sit contiguously in one array (a node's range starts at
+child_begin_[node]), and the processes without a listed parent are the
+children of one extra root node. The rollup is a single reverse pass over a
+breadth-first order, which visits every child before its parent.
+*/
+class ProcessTree {
+ public:
+  struct Row {
+    Process const* process;
+    int depth;                    // 0 for a process without a listed parent
+    unsigned long ticks;          // CPU ticks of the subtree in the interval
+    float cpu_utilization;        // of the subtree
+    long ram_kb;                  // resident, summed over the subtree
+    int descendants;
+  };
+
+  // Rebuild the tree over processes, in any order, and list the first n
+  // rows depth first. Siblings are ordered by subtree CPU, then memory,
+  // heaviest first, and only the siblings of listed rows are sorted.
+  void Build(std::vector<Process const*> const& processes, std::size_t n);
+  std::vector<Row> const& Rows() const;
+
+ private:
+  // PID to node, as an open-addressed table of (PID, node) pairs at least
+  // twice the node count, with PID 0 marking a free slot.
+  int Find(int pid) const;
+  std::vector<std::pair<int, int>> index_;
+  std::vector<int> parent_;             // node, or the extra root
+  std::vector<int> child_begin_;        // per node plus the root, and end
+  std::vector<int> children_;
+  std::vector<int> order_;  // breadth first from the root
+  std::vector<unsigned long> ticks_;
+  std::vector<float> cpu_;
+  std::vector<long> ram_kb_;
+  std::vector<int> descendants_;
+  std::vector<std::pair<int, int>> stack_;  // node and depth
+  std::vector<Row> rows_;
+};
+
+#endif
@@ -1,24 +1,32 @@
 #ifndef PROCESSOR_H
 #define PROCESSOR_H
 
+#include <vector>
+
+#include "linux_parser.h"
+
+/*
+Aggregate and per-core CPU utilization.
+Fed with every cpu line of one /proc/stat read; utilization is the share of
+non-idle jiffies since the previous sample.
+*/
 class Processor {
  public:
-  float Utilization();
-  long CurrentTotal();
-  long CurrentActive();
-  long CurrentIdle();
+  // Aggregate utilization as of the last sample.
+  float Utilization() const;
+  // Utilization of one core as of the last sample.
+  float Utilization(int core) const;
+  int Cores() const;
+  // Jiffies elapsed on each line during the last interval, indexed as
+  // for ParseCpuTimes.
+  std::vector<LinuxParser::CpuTimes> const& Deltas() const;
+  void Update(std::vector<LinuxParser::CpuTimes> const& times);
 
-  long PrevTotal();
-  long PrevIdle();
-  long PrevActive();
-  void Update(long idle, long active, long total);
-
- // Declare any necessary private members
+  // Declare any necessary private members
  private:
-  long idle_;
-  long active_;
-  long total_;
-
+  std::vector<LinuxParser::CpuTimes> prev_;
+  std::vector<LinuxParser::CpuTimes> deltas_;
+  std::vector<float> utilization_;  // [0] aggregate, [n + 1] cpuN
 };
 
-#endif
\ No newline at end of file
+#endif
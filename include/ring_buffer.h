@@ -0,0 +1,33 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <array>
+#include <cstddef>
+
+/*
+Fixed-capacity circular buffer. Push never allocates; once full, each new
+value replaces the oldest. Index 0 is the oldest value held.
+*/
+template <typename T, std::size_t N>
+class RingBuffer {
+ public:
+  void Push(T const& value) {
+    data_[(start_ + size_) % N] = value;
+    if (size_ < N) {
+      ++size_;
+    } else {
+      start_ = (start_ + 1) % N;
+    }
+  }
+  void Clear() { start_ = size_ = 0; }
+  std::size_t Size() const { return size_; }
+  static constexpr std::size_t Capacity() { return N; }
+  T const& operator[](std::size_t i) const { return data_[(start_ + i) % N]; }
+
+ private:
+  std::array<T, N> data_{};
+  std::size_t start_{0};
+  std::size_t size_{0};
+};
+
+#endif
@@ -1,27 +1,122 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "cgroup_activity.h"
+#include "device_activity.h"
+#include "proc_events.h"
 #include "process.h"
+#include "process_tree.h"
 #include "processor.h"
+#include "thread_pool.h"
+#include "user_cache.h"
 
 class System {
  public:
+  // workers is the size of the /proc scan pool; 0 picks one per hardware
+  // thread, up to kMaxDefaultWorkers.
+  explicit System(std::size_t workers = 0);
+  static constexpr std::size_t kMaxDefaultWorkers{8};
+
+  // Start a new frame: read /proc/stat, /proc/meminfo, /proc/diskstats and
+  // /proc/net/dev once each and sample the CPUs and devices from them.
+  void Update();
   Processor& Cpu();
-  std::vector<Process>& Processes();
+  DeviceActivity const& Devices() const;
+  // Take the PID list from the kernel's process events rather than a /proc
+  // scan per frame, and count the processes that come and go in between.
+  // Only for the live /proc; returns false, with errno set, when the events
+  // are unavailable, leaving polling in place.
+  bool WatchProcessEvents();
+  // The events during the last Processes() call's interval; inactive when
+  // polling.
+  ProcEventCounts const& Events() const;
+  // Refresh the process table and return its first n processes in key
+  // order: highest CPU, memory or I/O, lowest PID, newest first, or as a
+  // tree. The pointers stay valid until the next call.
+  std::vector<Process const*> const& Processes(SortKey key = SortKey::kCpu,
+                                               std::size_t n = SIZE_MAX);
+  // With SortKey::kTree, the rows Processes() returned, in the same order,
+  // with their depth and subtree totals.
+  ProcessTree const& Tree() const;
+  // Account every process of the last Processes() call to its cgroup, read
+  // each cgroup once, and return the first n in key order: highest CPU,
+  // memory or I/O, otherwise by path. Call at most once per frame.
+  std::vector<CgroupRate const*> const& Cgroups(SortKey key, std::size_t n);
+  // With memory detail on, Processes() also reads smaps_rollup (PSS and
+  // swap) for the rows it returns. Off by default: the kernel walks every
+  // mapping of a process to produce it.
+  void SetMemoryDetail(bool enabled);
+  bool MemoryDetail() const;
+  // Read /proc/<pid>/task for one process of the last Processes() call and
+  // return its threads, or nullptr if the PID is not in the table. Only
+  // the processes asked for are scanned, so the cost is bounded by the
+  // callers rather than multiplied across every process's threads.
+  std::vector<Process::Thread> const* Threads(int pid);
   float MemoryUtilization();
+  // The /proc/meminfo values read by the last Update().
+  LinuxParser::MemInfo const& Memory() const;
   long UpTime();
   int TotalProcesses();
   int RunningProcesses();
+  LinuxParser::SystemStatSnapshot const& Stat() const;
   std::string Kernel();
   std::string OperatingSystem();
 
   // Define any necessary private members
  private:
+  // Read smaps_rollup for processes_ when memory detail is on.
+  void ReadMemoryDetail();
+
   Processor cpu_ = {};
-  std::vector<Process> processes_ = {};
+  LinuxParser::SystemStatSnapshot stat_ = {};
+  LinuxParser::MemInfo memory_ = {};
+  DeviceActivity devices_ = {};
+  ProcEvents events_ = {};
+  ProcEventCounts event_counts_ = {};
+  CgroupActivity cgroups_ = {};
+  std::vector<CgroupRate const*> cgroup_rows_ = {};
+  std::string cgroup_path_ = {};
+  std::vector<LinuxParser::DiskStats> disk_stats_ = {};
+  std::vector<LinuxParser::NetDevStats> net_stats_ = {};
+  // Processes seen last frame, kept alive so that surviving PIDs only need
+  // their stat file re-read.
+  std::unordered_map<int, Process> table_ = {};
+  std::unordered_map<int, Process> next_table_ = {};
+  // Ranking works on this compact key array rather than on Process copies.
+  struct RankEntry {
+    double key;
+    Process const* process;
+  };
+  std::vector<RankEntry> ranking_ = {};
+  std::vector<Process const*> processes_ = {};
+  ProcessTree tree_ = {};
+  // Per-PID outcome of the parallel stat scan, merged into table_ serially.
+  struct ScanSlot {
+    enum class Kind { kGone, kRefreshed, kNew } kind;
+    LinuxParser::ProcessSnapshot snapshot;
+    // io of a new process, applied once its table entry exists.
+    enum class Io { kRead, kDenied, kFailed } io_state;
+    LinuxParser::ProcIo io;
+  };
+  std::vector<int> pids_ = {};  // this frame's listing
+  std::vector<ScanSlot> scan_ = {};
+  ThreadPool pool_;
+  bool memory_detail_ = false;
+  std::chrono::steady_clock::time_point updated_at_ = {};
+  double interval_ = 0;  // seconds between the last two Update() calls
+  long prev_jiffies_ = 0;
+  long jiffies_delta_ = 0;
+  unsigned long frame_ = 0;  // Update() calls so far
+  std::vector<int> tids_ = {};
+  std::vector<Process::Thread> threads_ = {};
+  UserCache users_{};
 };
 
 #endif
\ No newline at end of file
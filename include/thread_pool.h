@@ -0,0 +1,49 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Fixed set of worker threads for data-parallel loops. ParallelFor hands out
+contiguous chunks of an index range from a shared counter, so fast workers
+take more chunks and each chunk's output stays contiguous. The calling
+thread works too, so a pool of one worker runs everything inline.
+*/
+class ThreadPool {
+ public:
+  explicit ThreadPool(std::size_t workers);
+  ~ThreadPool();
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  std::size_t Workers() const;
+  // Run task(begin, end) over chunks covering [0, count) and wait for all.
+  void ParallelFor(std::size_t count,
+                   std::function<void(std::size_t, std::size_t)> const& task);
+
+ private:
+  void Work();
+  void RunChunks();
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  bool stopping_{false};
+  unsigned long generation_{0};
+  std::size_t busy_{0};
+
+  // The loop currently being run.
+  std::function<void(std::size_t, std::size_t)> const* task_{nullptr};
+  std::size_t count_{0};
+  std::size_t chunk_{1};
+  std::atomic<std::size_t> next_{0};
+};
+
+#endif
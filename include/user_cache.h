@@ -0,0 +1,34 @@
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+#include <sys/types.h>
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+
+#include "linux_parser.h"
+
+/*
+UID to user name map loaded once from /etc/passwd.
+The file is re-read only when its inode or mtime changes; UIDs it does not
+list (NSS/LDAP users) are resolved through getpwuid_r and remembered.
+*/
+class UserCache {
+ public:
+  explicit UserCache(std::string path = LinuxParser::kPasswordPath);
+  // Reload the passwd file if it changed on disk. Call once per frame.
+  void Refresh();
+  std::string const& Name(uid_t uid);
+
+ private:
+  void Load();
+
+  std::string path_;
+  ino_t inode_{0};
+  timespec mtime_{};
+  bool loaded_{false};
+  std::unordered_map<uid_t, std::string> names_;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "cgroup_activity.h"
+
+#include "linux_parser.h"
+
+using std::string;
+using std::vector;
+
+void CgroupActivity::Begin() { ++frame_; }
+
+void CgroupActivity::Add(string const& path) {
+  Entry& entry = entries_[path];
+  if (entry.frame != frame_) {
+    entry.frame = frame_;
+    entry.direct = 0;
+    entry.processes = 0;
+  }
+  ++entry.direct;
+}
+
+void CgroupActivity::Update(int cpus) {
+  // Credit every counted cgroup's processes to it and its ancestors. The
+  // root is only shown when processes sit in it directly, as it accounts
+  // for the whole machine.
+  leaves_.clear();
+  for (auto const& [path, entry] : entries_) {
+    if (entry.frame == frame_) leaves_.emplace_back(&path, entry.direct);
+  }
+  for (auto const& [path, direct] : leaves_) {
+    entries_[*path].processes += direct;
+    // "/a/b/c" also counts towards "/a/b" and "/a".
+    ancestor_ = *path;
+    size_t slash = ancestor_.rfind('/');
+    while (slash != 0 && slash != string::npos) {
+      ancestor_.resize(slash);
+      Entry& entry = entries_[ancestor_];
+      if (entry.frame != frame_) {
+        entry.frame = frame_;
+        entry.direct = 0;
+        entry.processes = 0;
+      }
+      entry.processes += direct;
+      slash = ancestor_.rfind('/');
+    }
+  }
+
+  // Rows are overwritten in place so their paths keep their storage.
+  size_t rows{0};
+  for (auto entry = entries_.begin(); entry != entries_.end();) {
+    Entry& cgroup = entry->second;
+    LinuxParser::CgroupStats stats;
+    // Each cgroup is timed on its own: reading thousands of them takes a
+    // fair part of a frame, so the frame's interval would skew the rates.
+    auto const now = std::chrono::steady_clock::now();
+    // Cgroups no longer holding processes, or removed, are forgotten.
+    if (cgroup.frame != frame_ ||
+        !LinuxParser::ReadCgroupStats(entry->first, stats)) {
+      entry = entries_.erase(entry);
+      continue;
+    }
+    double const seconds =
+        std::chrono::duration<double>(now - cgroup.read_at).count();
+    double const capacity = seconds * 1e6 * (cpus > 0 ? cpus : 1);
+    if (rows == cgroups_.size()) cgroups_.emplace_back();
+    CgroupRate& rate = cgroups_[rows++];
+    rate.path.assign(entry->first);
+    rate.processes = cgroup.processes;
+    rate.cpu_utilization = 0;
+    rate.memory_bytes = stats.memory_bytes;
+    rate.read_bytes = rate.write_bytes = -1;
+    // Rates need last frame's counters; a cgroup seen for the first time
+    // starts at 0.
+    bool const previous = cgroup.read_frame + 1 == frame_ && capacity > 0;
+    LinuxParser::CgroupStats const& before = cgroup.stats;
+    if (previous && stats.usage_usec >= before.usage_usec) {
+      rate.cpu_utilization =
+          float(double(stats.usage_usec - before.usage_usec) / capacity);
+    }
+    if (stats.has_io) {
+      rate.read_bytes = rate.write_bytes = 0;
+      if (previous && before.has_io && stats.read_bytes >= before.read_bytes &&
+          stats.write_bytes >= before.write_bytes) {
+        rate.read_bytes = double(stats.read_bytes - before.read_bytes) /
+                          seconds;
+        rate.write_bytes = double(stats.write_bytes - before.write_bytes) /
+                           seconds;
+      }
+    }
+    cgroup.stats = stats;
+    cgroup.read_frame = frame_;
+    cgroup.read_at = now;
+    ++entry;
+  }
+  cgroups_.resize(rows);
+}
+
+vector<CgroupRate> const& CgroupActivity::Cgroups() const { return cgroups_; }
@@ -0,0 +1,188 @@
+#include "collector.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+using std::chrono::steady_clock;
+
+Collector::Collector(System& system, std::chrono::milliseconds interval,
+                     int rows)
+    : system_(system),
+      interval_(interval),
+      rows_(rows),
+      operating_system_(system.OperatingSystem()),
+      kernel_(system.Kernel()) {}
+
+Collector::~Collector() { Stop(); }
+
+void Collector::Start() {
+  if (thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  thread_ = std::thread(&Collector::Run, this);
+}
+
+void Collector::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+std::shared_ptr<Frame const> Collector::Latest() const {
+  return std::atomic_load(&latest_);
+}
+
+void Collector::SetSortKey(SortKey key) { sort_key_.store(key); }
+
+void Collector::SetThreadRows(int rows) { thread_rows_.store(rows); }
+
+void Collector::SetCgroups(bool enabled) { cgroups_.store(enabled); }
+
+void Collector::ToggleThreads(int pid) {
+  std::lock_guard<std::mutex> lock(expanded_mutex_);
+  if (expanded_.erase(pid) == 0) expanded_.insert(pid);
+}
+
+void Collector::Prime() {
+  primed_ = true;
+  Sample();
+  --sequence_;
+  cpu_history_.Clear();
+  memory_history_.Clear();
+}
+
+std::shared_ptr<Frame> Collector::Sample() {
+  if (!primed_) {
+    Prime();
+    std::this_thread::sleep_for(
+        std::min(interval_, std::chrono::milliseconds(200)));
+  }
+  auto frame = std::make_shared<Frame>();
+  frame->sampled_at = steady_clock::now();
+  frame->wall_time = std::chrono::system_clock::now();
+  frame->sequence = ++sequence_;
+  frame->operating_system = operating_system_;
+  frame->kernel = kernel_;
+
+  system_.Update();
+  Processor const& cpu = system_.Cpu();
+  frame->cpu_utilization = cpu.Utilization();
+  frame->core_utilization.resize(cpu.Cores());
+  for (int core = 0; core < cpu.Cores(); ++core) {
+    frame->core_utilization[core] = cpu.Utilization(core);
+  }
+  frame->cpu_deltas = cpu.Deltas();
+  frame->memory_utilization = system_.MemoryUtilization();
+  frame->swap_utilization = system_.Memory().SwapUtilization();
+  frame->cache_utilization = system_.Memory().CacheUtilization();
+  cpu_history_.Push(frame->cpu_utilization);
+  memory_history_.Push(frame->memory_utilization);
+  frame->cpu_history = cpu_history_;
+  frame->memory_history = memory_history_;
+  frame->disks = system_.Devices().Disks();
+  frame->interfaces = system_.Devices().Interfaces();
+  frame->total_processes = system_.TotalProcesses();
+  frame->running_processes = system_.RunningProcesses();
+  frame->uptime = system_.UpTime();
+
+  frame->sort_key = sort_key_.load();
+  frame->memory_detail = system_.MemoryDetail();
+  std::vector<Process const*> const& processes =
+      system_.Processes(frame->sort_key, size_t(rows_));
+  frame->process_events = system_.Events();
+  frame->processes.reserve(processes.size());
+  auto megabytes = [](long kb) { return kb < 0 ? -1 : kb / 1000; };
+  for (Process const* process : processes) {
+    frame->processes.push_back(
+        {process->Pid(), process->User(), process->Command(),
+         process->CpuUtilization(), process->CpuTicks(),
+         process->RamKb() / 1000, process->UpTime(),
+         process->CpuUtilizationHistory(),
+         megabytes(frame->memory_detail ? process->PssKb() : -1),
+         megabytes(frame->memory_detail ? process->SwapKb() : -1),
+         process->ReadRate(), process->WriteRate()});
+  }
+  if (frame->sort_key == SortKey::kTree) {
+    std::vector<ProcessTree::Row> const& tree = system_.Tree().Rows();
+    for (size_t i = 0; i < frame->processes.size(); ++i) {
+      ProcessRow& row = frame->processes[i];
+      row.depth = tree[i].depth;
+      row.tree_ticks = tree[i].ticks;
+      row.tree_cpu_utilization = tree[i].cpu_utilization;
+      row.tree_ram = tree[i].ram_kb / 1000;
+    }
+  }
+  // Threads only for the rows asked for, so the scan stays bounded.
+  int const thread_rows = thread_rows_.load();
+  std::unordered_set<int> expanded;
+  {
+    std::lock_guard<std::mutex> lock(expanded_mutex_);
+    expanded = expanded_;
+  }
+  auto busier = [](Process::Thread const& a, Process::Thread const& b) {
+    return a.cpu_utilization > b.cpu_utilization;
+  };
+  for (size_t i = 0; i < frame->processes.size(); ++i) {
+    ProcessRow& row = frame->processes[i];
+    if (int(i) >= thread_rows && expanded.count(row.pid) == 0) continue;
+    if (auto const* threads = system_.Threads(row.pid)) {
+      row.threads = *threads;
+      std::stable_sort(row.threads.begin(), row.threads.end(), busier);
+    }
+  }
+  if (cgroups_.load()) {
+    for (CgroupRate const* cgroup :
+         system_.Cgroups(frame->sort_key, size_t(rows_))) {
+      frame->cgroups.push_back(*cgroup);
+    }
+  }
+
+  frame->collection_time = steady_clock::now() - frame->sampled_at;
+  return frame;
+}
+
+void Collector::OnFrame(std::function<void(Frame const&)> observer) {
+  observer_ = std::move(observer);
+}
+
+void Collector::Run() {
+  Collect(0, [this](std::shared_ptr<Frame> frame) {
+    if (observer_) observer_(*frame);
+    std::atomic_store(&latest_, std::shared_ptr<Frame const>(std::move(frame)));
+  });
+}
+
+// Sample at start + k * interval, starting one interval after the baseline
+// (or the previous Sample()) so the first frame covers a full interval. A
+// sample that overruns its slot skips the slots it missed rather than
+// firing a burst to catch up.
+void Collector::Collect(
+    unsigned long count,
+    std::function<void(std::shared_ptr<Frame>)> const& sink) {
+  if (!primed_) Prime();
+  steady_clock::time_point next = steady_clock::now() + interval_;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (unsigned long collected = 0; count == 0 || collected < count;
+       ++collected) {
+    if (wake_.wait_until(lock, next, [this] { return stopping_; })) {
+      break;
+    }
+    lock.unlock();
+    auto const started = steady_clock::now();
+    std::shared_ptr<Frame> frame = Sample();
+    frame->jitter = started - next;
+    sink(std::move(frame));
+
+    auto const now = steady_clock::now();
+    do {
+      next += interval_;
+    } while (next <= now);
+    lock.lock();
+  }
+}
@@ -0,0 +1,82 @@
+#include "device_activity.h"
+
+#include <cstring>
+
+#include "linux_parser.h"
+
+using std::vector;
+
+namespace {
+// Devices keep their order between reads, so the previous sample of entry i
+// is almost always at i; fall back to a scan when the list changed.
+template <typename Stats>
+Stats const* Previous(vector<Stats> const& previous, size_t index,
+                      char const* name) {
+  if (index < previous.size() &&
+      std::strcmp(previous[index].name, name) == 0) {
+    return &previous[index];
+  }
+  for (Stats const& stats : previous) {
+    if (std::strcmp(stats.name, name) == 0) return &stats;
+  }
+  return nullptr;
+}
+
+// Per-second rate of a counter, or 0 without an interval or on a reset.
+double Rate(unsigned long long now, unsigned long long before,
+            double seconds) {
+  return seconds > 0 && now >= before ? double(now - before) / seconds : 0;
+}
+}  // namespace
+
+vector<DiskRate> const& DeviceActivity::Disks() const { return disks_; }
+
+vector<NetRate> const& DeviceActivity::Interfaces() const {
+  return interfaces_;
+}
+
+void DeviceActivity::UpdateDisks(vector<LinuxParser::DiskStats> const& disks,
+                                 double seconds) {
+  disks_.resize(disks.size());
+  for (size_t i = 0; i < disks.size(); ++i) {
+    LinuxParser::DiskStats const& now = disks[i];
+    LinuxParser::DiskStats const* before = Previous(prev_disks_, i, now.name);
+    DiskRate& rate = disks_[i];
+    if (before == nullptr) {
+      rate = DiskRate{now.name};  // no interval yet
+      continue;
+    }
+    rate.name = now.name;
+    rate.reads = Rate(now.reads, before->reads, seconds);
+    rate.writes = Rate(now.writes, before->writes, seconds);
+    rate.read_bytes =
+        Rate(now.sectors_read, before->sectors_read, seconds) * 512;
+    rate.write_bytes =
+        Rate(now.sectors_written, before->sectors_written, seconds) * 512;
+    // io_ticks is in milliseconds.
+    rate.utilization =
+        float(Rate(now.io_ticks, before->io_ticks, seconds) / 1000);
+  }
+  prev_disks_ = disks;
+}
+
+void DeviceActivity::UpdateInterfaces(
+    vector<LinuxParser::NetDevStats> const& interfaces, double seconds) {
+  interfaces_.resize(interfaces.size());
+  for (size_t i = 0; i < interfaces.size(); ++i) {
+    LinuxParser::NetDevStats const& now = interfaces[i];
+    LinuxParser::NetDevStats const* before =
+        Previous(prev_interfaces_, i, now.name);
+    NetRate& rate = interfaces_[i];
+    if (before == nullptr) {
+      rate = NetRate{now.name};  // no interval yet
+      continue;
+    }
+    rate.name = now.name;
+    rate.rx_bytes = Rate(now.rx_bytes, before->rx_bytes, seconds);
+    rate.tx_bytes = Rate(now.tx_bytes, before->tx_bytes, seconds);
+    rate.rx_packets = Rate(now.rx_packets, before->rx_packets, seconds);
+    rate.tx_packets = Rate(now.tx_packets, before->tx_packets, seconds);
+  }
+  prev_interfaces_ = interfaces;
+}
@@ -0,0 +1,41 @@
+#include "diff_window.h"
+
+#include <algorithm>
+
+DiffWindow::DiffWindow(WINDOW* window)
+    : window_(window),
+      width_(std::max(0, getmaxx(window) - 2)),
+      scratch_(size_t(width_), ' '),
+      drawn_(size_t(std::max(0, getmaxy(window))) * size_t(width_), 0) {}
+
+WINDOW* DiffWindow::Window() const { return window_; }
+
+int DiffWindow::Width() const { return width_; }
+
+void DiffWindow::BeginRow(int row) {
+  row_ = row;
+  std::fill(scratch_.begin(), scratch_.end(), chtype(' '));
+}
+
+// Columns are window columns, so column 1 is the first inside the border.
+void DiffWindow::Put(int column, char const* text, chtype attributes) {
+  for (int cell = column - 1; *text != '\0' && cell < width_; ++text, ++cell) {
+    if (cell >= 0) {
+      scratch_[cell] = chtype(static_cast<unsigned char>(*text)) | attributes;
+    }
+  }
+}
+
+void DiffWindow::EndRow() {
+  if (row_ < 0 || size_t(row_ + 1) * width_ > drawn_.size()) return;
+  chtype* const drawn = drawn_.data() + size_t(row_) * width_;
+  int first{0};
+  while (first < width_ && scratch_[first] == drawn[first]) ++first;
+  if (first == width_) return;
+  int last{width_ - 1};
+  while (scratch_[last] == drawn[last]) --last;
+  mvwaddchnstr(window_, row_, first + 1, scratch_.data() + first,
+               last - first + 1);
+  std::copy(scratch_.begin() + first, scratch_.begin() + last + 1,
+            drawn + first);
+}
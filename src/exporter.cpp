@@ -0,0 +1,277 @@
+#include "exporter.h"
+
+#include <charconv>
+#include <chrono>
+
+using std::chrono::duration;
+
+Exporter::Exporter(std::FILE* out, Format format)
+    : out_(out), format_(format) {}
+
+void Exporter::Write(Frame const& frame) {
+  buffer_.clear();
+  if (format_ == Format::kJsonLines) {
+    AppendJson(frame);
+  } else {
+    AppendCsv(frame);
+  }
+  std::fwrite(buffer_.data(), 1, buffer_.size(), out_);
+  std::fflush(out_);
+}
+
+void Exporter::AppendNumber(long long value) {
+  char digits[24];
+  auto const result = std::to_chars(digits, digits + sizeof(digits), value);
+  buffer_.append(digits, result.ptr);
+}
+
+void Exporter::AppendNumber(double value, int precision) {
+  char digits[48];
+  auto const result =
+      std::to_chars(digits, digits + sizeof(digits), value,
+                    std::chars_format::fixed, precision);
+  buffer_.append(digits, result.ptr);
+}
+
+void Exporter::AppendJsonString(std::string const& value) {
+  static char const kHex[] = "0123456789abcdef";
+  buffer_ += '"';
+  for (char c : value) {
+    unsigned char const byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      buffer_ += '\\';
+      buffer_ += c;
+    } else if (byte < 0x20) {
+      buffer_ += "\\u00";
+      buffer_ += kHex[byte >> 4];
+      buffer_ += kHex[byte & 0xf];
+    } else {
+      buffer_ += c;
+    }
+  }
+  buffer_ += '"';
+}
+
+// Quote every string field and double embedded quotes (RFC 4180).
+void Exporter::AppendCsvString(std::string const& value) {
+  buffer_ += '"';
+  for (char c : value) {
+    if (c == '"') buffer_ += '"';
+    buffer_ += c;
+  }
+  buffer_ += '"';
+}
+
+void Exporter::AppendJson(Frame const& frame) {
+  double const time =
+      duration<double>(frame.wall_time.time_since_epoch()).count();
+  buffer_ += "{\"seq\":";
+  AppendNumber((long long)frame.sequence);
+  buffer_ += ",\"time\":";
+  AppendNumber(time, 3);
+  buffer_ += ",\"collect_ms\":";
+  AppendNumber(duration<double, std::milli>(frame.collection_time).count(), 3);
+  buffer_ += ",\"jitter_ms\":";
+  AppendNumber(duration<double, std::milli>(frame.jitter).count(), 3);
+  buffer_ += ",\"cpu\":";
+  AppendNumber(frame.cpu_utilization, 4);
+  buffer_ += ",\"cores\":[";
+  for (size_t i = 0; i < frame.core_utilization.size(); ++i) {
+    if (i > 0) buffer_ += ',';
+    AppendNumber(frame.core_utilization[i], 4);
+  }
+  buffer_ += "],\"memory\":";
+  AppendNumber(frame.memory_utilization, 4);
+  buffer_ += ",\"swap\":";
+  AppendNumber(frame.swap_utilization, 4);
+  buffer_ += ",\"cache\":";
+  AppendNumber(frame.cache_utilization, 4);
+  buffer_ += ",\"disks\":[";
+  for (size_t i = 0; i < frame.disks.size(); ++i) {
+    DiskRate const& disk = frame.disks[i];
+    buffer_ += i > 0 ? ",{\"name\":" : "{\"name\":";
+    AppendJsonString(disk.name);
+    buffer_ += ",\"reads\":";
+    AppendNumber(disk.reads, 1);
+    buffer_ += ",\"writes\":";
+    AppendNumber(disk.writes, 1);
+    buffer_ += ",\"read_bps\":";
+    AppendNumber((long long)disk.read_bytes);
+    buffer_ += ",\"write_bps\":";
+    AppendNumber((long long)disk.write_bytes);
+    buffer_ += ",\"util\":";
+    AppendNumber(disk.utilization, 4);
+    buffer_ += '}';
+  }
+  buffer_ += "],\"net\":[";
+  for (size_t i = 0; i < frame.interfaces.size(); ++i) {
+    NetRate const& interface = frame.interfaces[i];
+    buffer_ += i > 0 ? ",{\"name\":" : "{\"name\":";
+    AppendJsonString(interface.name);
+    buffer_ += ",\"rx_bps\":";
+    AppendNumber((long long)interface.rx_bytes);
+    buffer_ += ",\"tx_bps\":";
+    AppendNumber((long long)interface.tx_bytes);
+    buffer_ += ",\"rx_pps\":";
+    AppendNumber(interface.rx_packets, 1);
+    buffer_ += ",\"tx_pps\":";
+    AppendNumber(interface.tx_packets, 1);
+    buffer_ += '}';
+  }
+  buffer_ += ']';
+  buffer_ += ",\"total_processes\":";
+  AppendNumber(frame.total_processes);
+  buffer_ += ",\"running_processes\":";
+  AppendNumber(frame.running_processes);
+  if (frame.process_events.active) {
+    ProcEventCounts const& events = frame.process_events;
+    buffer_ += ",\"events\":{\"forks\":";
+    AppendNumber((long long)events.forks);
+    buffer_ += ",\"execs\":";
+    AppendNumber((long long)events.execs);
+    buffer_ += ",\"exits\":";
+    AppendNumber((long long)events.exits);
+    buffer_ += ",\"short_lived\":";
+    AppendNumber((long long)events.short_lived);
+    buffer_ += '}';
+  }
+  buffer_ += ",\"uptime\":";
+  AppendNumber(frame.uptime);
+  buffer_ += ",\"processes\":[";
+  for (size_t i = 0; i < frame.processes.size(); ++i) {
+    ProcessRow const& process = frame.processes[i];
+    buffer_ += i > 0 ? ",{\"pid\":" : "{\"pid\":";
+    AppendNumber(process.pid);
+    buffer_ += ",\"user\":";
+    AppendJsonString(process.user);
+    buffer_ += ",\"cpu\":";
+    AppendNumber(process.cpu_utilization, 4);
+    buffer_ += ",\"ram_mb\":";
+    AppendNumber(process.ram);
+    if (process.pss >= 0) {
+      buffer_ += ",\"pss_mb\":";
+      AppendNumber(process.pss);
+      buffer_ += ",\"swap_mb\":";
+      AppendNumber(process.swap);
+    }
+    if (process.read_rate >= 0) {
+      buffer_ += ",\"read_bps\":";
+      AppendNumber((long long)process.read_rate);
+      buffer_ += ",\"write_bps\":";
+      AppendNumber((long long)process.write_rate);
+    }
+    if (frame.sort_key == SortKey::kTree) {
+      buffer_ += ",\"depth\":";
+      AppendNumber(process.depth);
+      buffer_ += ",\"tree_cpu\":";
+      AppendNumber(process.tree_cpu_utilization, 4);
+      buffer_ += ",\"tree_ram_mb\":";
+      AppendNumber(process.tree_ram);
+    }
+    buffer_ += ",\"uptime\":";
+    AppendNumber(process.uptime);
+    buffer_ += ",\"command\":";
+    AppendJsonString(process.command);
+    if (!process.threads.empty()) {
+      buffer_ += ",\"threads\":[";
+      for (size_t t = 0; t < process.threads.size(); ++t) {
+        Process::Thread const& thread = process.threads[t];
+        buffer_ += t > 0 ? ",{\"tid\":" : "{\"tid\":";
+        AppendNumber(thread.tid);
+        buffer_ += ",\"name\":";
+        AppendJsonString(thread.name);
+        buffer_ += ",\"cpu\":";
+        AppendNumber(thread.cpu_utilization, 4);
+        buffer_ += '}';
+      }
+      buffer_ += ']';
+    }
+    buffer_ += '}';
+  }
+  buffer_ += ']';
+  if (!frame.cgroups.empty()) {
+    buffer_ += ",\"cgroups\":[";
+    for (size_t i = 0; i < frame.cgroups.size(); ++i) {
+      CgroupRate const& cgroup = frame.cgroups[i];
+      buffer_ += i > 0 ? ",{\"path\":" : "{\"path\":";
+      AppendJsonString(cgroup.path);
+      buffer_ += ",\"processes\":";
+      AppendNumber(cgroup.processes);
+      buffer_ += ",\"cpu\":";
+      AppendNumber(cgroup.cpu_utilization, 4);
+      if (cgroup.memory_bytes >= 0) {
+        buffer_ += ",\"mem_bytes\":";
+        AppendNumber(cgroup.memory_bytes);
+      }
+      if (cgroup.read_bytes >= 0) {
+        buffer_ += ",\"read_bps\":";
+        AppendNumber((long long)cgroup.read_bytes);
+        buffer_ += ",\"write_bps\":";
+        AppendNumber((long long)cgroup.write_bytes);
+      }
+      buffer_ += '}';
+    }
+    buffer_ += ']';
+  }
+  buffer_ += "}\n";
+}
+
+void Exporter::AppendCsv(Frame const& frame) {
+  if (!wrote_header_) {
+    buffer_ +=
+        "time,seq,cpu,memory,swap,cache,total_processes,running_processes,uptime,"
+        "pid,user,process_cpu,ram_mb,pss_mb,swap_mb,read_bps,write_bps,process_uptime,command\n";
+    wrote_header_ = true;
+  }
+  double const time =
+      duration<double>(frame.wall_time.time_since_epoch()).count();
+  auto append_system = [&] {
+    AppendNumber(time, 3);
+    buffer_ += ',';
+    AppendNumber((long long)frame.sequence);
+    buffer_ += ',';
+    AppendNumber(frame.cpu_utilization, 4);
+    buffer_ += ',';
+    AppendNumber(frame.memory_utilization, 4);
+    buffer_ += ',';
+    AppendNumber(frame.swap_utilization, 4);
+    buffer_ += ',';
+    AppendNumber(frame.cache_utilization, 4);
+    buffer_ += ',';
+    AppendNumber(frame.total_processes);
+    buffer_ += ',';
+    AppendNumber(frame.running_processes);
+    buffer_ += ',';
+    AppendNumber(frame.uptime);
+    buffer_ += ',';
+  };
+  if (frame.processes.empty()) {
+    append_system();
+    buffer_ += ",,,,,,,,,\n";
+    return;
+  }
+  for (ProcessRow const& process : frame.processes) {
+    append_system();
+    AppendNumber(process.pid);
+    buffer_ += ',';
+    AppendCsvString(process.user);
+    buffer_ += ',';
+    AppendNumber(process.cpu_utilization, 4);
+    buffer_ += ',';
+    AppendNumber(process.ram);
+    buffer_ += ',';
+    // Left empty unless smaps_rollup was read for the row.
+    if (process.pss >= 0) AppendNumber(process.pss);
+    buffer_ += ',';
+    if (process.swap >= 0) AppendNumber(process.swap);
+    buffer_ += ',';
+    if (process.read_rate >= 0) AppendNumber((long long)process.read_rate);
+    buffer_ += ',';
+    if (process.write_rate >= 0) AppendNumber((long long)process.write_rate);
+    buffer_ += ',';
+    AppendNumber(process.uptime);
+    buffer_ += ',';
+    AppendCsvString(process.command);
+    buffer_ += '\n';
+  }
+}
@@ -1,5 +1,6 @@
 #include "format.h"
 
+#include <cstdio>
 #include <string>
 
 using std::string;
@@ -12,4 +13,24 @@ string Format::ElapsedTime(long seconds) {
   seconds = seconds % 60;
   return std::to_string(hours) + ":" + std::to_string(minutes) + ":" +
          std::to_string(seconds);
-}
\ No newline at end of file
+}
+
+void Format::ElapsedTime(long seconds, char* out, std::size_t size) {
+  std::snprintf(out, size, "%ld:%ld:%ld", seconds / 3600, seconds % 3600 / 60,
+                seconds % 60);
+}
+
+void Format::Bytes(double bytes, char* out, std::size_t size) {
+  static char const kSuffixes[] = "KMGT";
+  if (bytes < 1024) {
+    std::snprintf(out, size, "%.0f", bytes);
+    return;
+  }
+  int suffix{-1};
+  while (bytes >= 1024 && suffix < int(sizeof(kSuffixes)) - 2) {
+    bytes /= 1024;
+    ++suffix;
+  }
+  std::snprintf(out, size, bytes < 10 ? "%.1f%c" : "%.0f%c", bytes,
+                kSuffixes[suffix]);
+}
@@ -0,0 +1,384 @@
+#include "history.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::uint8_t;
+
+namespace {
+char const kMagic[8] = {'M', 'O', 'N', 'H', 'I', 'S', 'T', '6'};
+uint32_t const kStringSlots{4096};
+uint32_t const kStringSize{64};  // one length byte and up to 63 characters
+
+struct Header {
+  char magic[8];
+  uint32_t slot_count;
+  uint32_t slot_size;
+  uint32_t string_count;
+  uint32_t reserved;
+  uint64_t frames_written;
+  char operating_system[128];
+  char kernel[64];
+};
+
+// Each slot starts with the number of the frame in it plus one, 0 while it
+// is being written, and the length of the varint payload that follows. A
+// reader checks number before and after copying the slot, as a seqlock.
+struct SlotHeader {
+  uint64_t number;
+  uint32_t length;
+  uint32_t reserved;
+};
+
+size_t StringsOffset() { return (sizeof(Header) + 63) / 64 * 64; }
+size_t SlotsOffset() { return StringsOffset() + kStringSlots * kStringSize; }
+
+// Bounded LEB128 writer; sets overflow instead of writing past the slot.
+struct Encoder {
+  uint8_t* p;
+  uint8_t* end;
+  bool overflow{false};
+
+  void Put(uint64_t value) {
+    do {
+      if (p == end) {
+        overflow = true;
+        return;
+      }
+      uint8_t const byte = value & 0x7f;
+      value >>= 7;
+      *p++ = value != 0 ? byte | 0x80 : byte;
+    } while (value != 0);
+  }
+  void PutSigned(long long value) {
+    Put((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+  }
+  void PutBytes(char const* data, size_t length) {
+    if (size_t(end - p) < length) {
+      overflow = true;
+      return;
+    }
+    std::memcpy(p, data, length);
+    p += length;
+  }
+};
+
+struct Decoder {
+  uint8_t const* p;
+  uint8_t const* end;
+
+  uint64_t Get() {
+    uint64_t value{0};
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+      uint8_t const byte = *p++;
+      value |= uint64_t(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    return value;
+  }
+  long long GetSigned() {
+    uint64_t const value = Get();
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+  }
+  std::string GetBytes(uint64_t length) {
+    length = std::min<uint64_t>(length, uint64_t(end - p));
+    std::string value(reinterpret_cast<char const*>(p), size_t(length));
+    p += length;
+    return value;
+  }
+};
+
+void CopyString(char* out, size_t capacity, std::string const& value) {
+  size_t const length = std::min(value.size(), capacity - 1);
+  std::memcpy(out, value.data(), length);
+  out[length] = '\0';
+}
+
+float Ratio(long part, long whole) {
+  return whole > 0 ? float(part) / float(whole) : 0.0f;
+}
+}  // namespace
+
+HistoryWriter::~HistoryWriter() {
+  if (map_ != nullptr) munmap(map_, size_);
+}
+
+bool HistoryWriter::Open(std::string const& path, size_t frames,
+                         size_t rows) {
+  long const cpus = std::max(1L, sysconf(_SC_NPROCESSORS_CONF));
+  // Worst-case varint sizes: ten bytes per counter, headers included, and
+  // room for both of a row's strings inline.
+  size_t const slot_size =
+      (sizeof(SlotHeader) + 13 * 10 + 2 * 10 * size_t(cpus + 1) +
+       (11 * 10 + 2 * kStringSize) * rows + 7) /
+      8 * 8;
+  size_t const size = SlotsOffset() + std::max<size_t>(frames, 1) * slot_size;
+
+  int const fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                      0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool const sized = ftruncate(fd, off_t(size)) == 0;
+  void* map = sized ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fd, 0)
+                    : MAP_FAILED;
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  map_ = static_cast<uint8_t*>(map);
+  size_ = size;
+  rows_ = rows;
+
+  Header* header = reinterpret_cast<Header*>(map_);
+  std::memcpy(header->magic, kMagic, sizeof(kMagic));
+  header->slot_count = uint32_t(std::max<size_t>(frames, 1));
+  header->slot_size = uint32_t(slot_size);
+  return true;
+}
+
+uint32_t HistoryWriter::Intern(std::string const& key) {
+  auto found = strings_.find(key);
+  if (found != strings_.end()) {
+    return found->second;
+  }
+  Header* header = reinterpret_cast<Header*>(map_);
+  if (header->string_count == kStringSlots) {
+    return kStringSlots;
+  }
+  uint32_t const id = header->string_count;
+  uint8_t* slot = map_ + StringsOffset() + size_t(id) * kStringSize;
+  slot[0] = uint8_t(key.size());
+  std::memcpy(slot + 1, key.data(), key.size());
+  // A reader may look the entry up as soon as the count covers it.
+  __atomic_store_n(&header->string_count, id + 1, __ATOMIC_RELEASE);
+  strings_.emplace(key, id);
+  return id;
+}
+
+bool HistoryWriter::Record(Frame const& frame) {
+  if (map_ == nullptr) {
+    return false;
+  }
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  using std::chrono::milliseconds;
+  Header* header = reinterpret_cast<Header*>(map_);
+  if (header->operating_system[0] == '\0') {
+    CopyString(header->operating_system, sizeof(header->operating_system),
+               frame.operating_system);
+    CopyString(header->kernel, sizeof(header->kernel), frame.kernel);
+  }
+
+  // Strings are a varint: a table id shifted left or, once the table is
+  // full, a length with the low bit set followed by the characters. Older
+  // records keep their ids, so they stay replayable.
+  auto put_string = [this](Encoder& out, std::string const& value) {
+    key_.assign(value, 0, kStringSize - 1);
+    uint32_t const id = Intern(key_);
+    if (id < kStringSlots) {
+      out.Put(uint64_t(id) << 1);
+    } else {
+      out.Put(uint64_t(key_.size()) << 1 | 1);
+      out.PutBytes(key_.data(), key_.size());
+    }
+  };
+  size_t const rows = std::min(frame.processes.size(), rows_);
+  uint64_t const number = header->frames_written;
+  uint8_t* const slot = map_ + SlotsOffset() +
+                        size_t(number % header->slot_count) *
+                            header->slot_size;
+  // Retire the slot's previous frame before overwriting it.
+  uint64_t* const slot_number =
+      reinterpret_cast<uint64_t*>(slot + offsetof(SlotHeader, number));
+  __atomic_store_n(slot_number, uint64_t(0), __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  Encoder out{slot + sizeof(SlotHeader), slot + header->slot_size};
+  out.Put(frame.sequence);
+  out.Put(uint64_t(duration_cast<milliseconds>(
+                       frame.wall_time.time_since_epoch())
+                       .count()));
+  out.Put(uint64_t(duration_cast<microseconds>(frame.collection_time).count()));
+  out.PutSigned(duration_cast<microseconds>(frame.jitter).count());
+  out.Put(uint64_t(frame.sort_key));
+  out.Put(uint64_t(std::max(0L, frame.uptime)));
+  out.Put(uint64_t(std::max(0, frame.total_processes)));
+  out.Put(uint64_t(std::max(0, frame.running_processes)));
+  out.Put(uint64_t(frame.memory_utilization * 10000.0f + 0.5f));
+  out.Put(uint64_t(frame.swap_utilization * 10000.0f + 0.5f));
+  out.Put(uint64_t(frame.cache_utilization * 10000.0f + 0.5f));
+  out.Put(frame.cpu_deltas.size());
+  for (LinuxParser::CpuTimes const& delta : frame.cpu_deltas) {
+    out.Put(uint64_t(std::max(0L, delta.active)));
+    out.Put(uint64_t(std::max(0L, delta.idle)));
+  }
+  out.Put(rows);
+  for (size_t i = 0; i < rows; ++i) {
+    ProcessRow const& process = frame.processes[i];
+    out.Put(uint64_t(process.pid));
+    put_string(out, process.user);
+    put_string(out, process.command);
+    out.Put(process.cpu_ticks);
+    out.Put(uint64_t(std::max(0L, process.ram)));
+    out.Put(uint64_t(std::max(0L, process.uptime)));
+    // Rates are stored plus one so that -1 (io not readable) fits.
+    out.Put(uint64_t(std::max(0.0, process.read_rate + 1)));
+    out.Put(uint64_t(std::max(0.0, process.write_rate + 1)));
+    out.Put(uint64_t(std::max(0, process.depth)));
+    out.Put(process.tree_ticks);
+    out.Put(uint64_t(std::max(0L, process.tree_ram)));
+  }
+  if (out.overflow) {
+    return false;  // more CPUs than the file was sized for
+  }
+  uint32_t const length = uint32_t(out.p - slot - sizeof(SlotHeader));
+  std::memcpy(slot + offsetof(SlotHeader, length), &length, sizeof(length));
+  // Publish the record only after it is complete.
+  __atomic_store_n(slot_number, number + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&header->frames_written, number + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+HistoryReader::~HistoryReader() {
+  if (map_ != nullptr) munmap(const_cast<uint8_t*>(map_), size_);
+}
+
+bool HistoryReader::Open(std::string const& path) {
+  int const fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  void* map = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && size_t(info.st_size) >= SlotsOffset()) {
+    map = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  map_ = static_cast<uint8_t const*>(map);
+  size_ = size_t(info.st_size);
+
+  Header const* header = reinterpret_cast<Header const*>(map_);
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->slot_count == 0 ||
+      SlotsOffset() + size_t(header->slot_count) * header->slot_size > size_) {
+    return false;
+  }
+  return true;
+}
+
+size_t HistoryReader::Frames() const {
+  if (map_ == nullptr) return 0;
+  Header const* header = reinterpret_cast<Header const*>(map_);
+  uint64_t const written =
+      __atomic_load_n(&header->frames_written, __ATOMIC_ACQUIRE);
+  return size_t(std::min<uint64_t>(written, header->slot_count));
+}
+
+std::shared_ptr<Frame> HistoryReader::Read(size_t index) const {
+  if (map_ == nullptr) return nullptr;
+  Header const* header = reinterpret_cast<Header const*>(map_);
+  uint64_t const written =
+      __atomic_load_n(&header->frames_written, __ATOMIC_ACQUIRE);
+  uint64_t const frames = std::min<uint64_t>(written, header->slot_count);
+  if (index >= frames) {
+    return nullptr;
+  }
+  uint64_t const number = written - frames + index;
+  uint8_t const* const slot =
+      map_ + SlotsOffset() +
+      size_t(number % header->slot_count) * header->slot_size;
+
+  // Copy the slot out and decode the copy. A recorder still running may
+  // reuse the slot meanwhile; the frame is then dropped, not torn.
+  uint64_t const* const slot_number =
+      reinterpret_cast<uint64_t const*>(slot + offsetof(SlotHeader, number));
+  if (__atomic_load_n(slot_number, __ATOMIC_ACQUIRE) != number + 1) {
+    return nullptr;
+  }
+  std::vector<uint8_t> copy(slot, slot + header->slot_size);
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(slot_number, __ATOMIC_RELAXED) != number + 1) {
+    return nullptr;
+  }
+  SlotHeader slot_header;
+  std::memcpy(&slot_header, copy.data(), sizeof(slot_header));
+  if (slot_header.length > header->slot_size - sizeof(SlotHeader)) {
+    return nullptr;
+  }
+
+  // The table only grows, and entries never change once counted.
+  uint32_t const strings = std::min(
+      __atomic_load_n(&header->string_count, __ATOMIC_ACQUIRE), kStringSlots);
+  Decoder in{copy.data() + sizeof(SlotHeader),
+             copy.data() + sizeof(SlotHeader) + slot_header.length};
+  auto get_string = [&]() {
+    uint64_t const value = in.Get();
+    if (value & 1) return in.GetBytes(value >> 1);
+    uint64_t const id = value >> 1;
+    if (id >= strings) return std::string("?");
+    uint8_t const* entry = map_ + StringsOffset() + size_t(id) * kStringSize;
+    return std::string(reinterpret_cast<char const*>(entry + 1),
+                       std::min<size_t>(entry[0], kStringSize - 1));
+  };
+  auto frame = std::make_shared<Frame>();
+  frame->operating_system = header->operating_system;
+  frame->kernel = header->kernel;
+  frame->sequence = in.Get();
+  frame->wall_time = std::chrono::system_clock::time_point(
+      std::chrono::milliseconds(in.Get()));
+  frame->collection_time = std::chrono::microseconds(in.Get());
+  frame->jitter = std::chrono::microseconds(in.GetSigned());
+  frame->sort_key = SortKey(in.Get());
+  frame->uptime = long(in.Get());
+  frame->total_processes = int(in.Get());
+  frame->running_processes = int(in.Get());
+  frame->memory_utilization = float(in.Get()) / 10000.0f;
+  frame->swap_utilization = float(in.Get()) / 10000.0f;
+  frame->cache_utilization = float(in.Get()) / 10000.0f;
+  frame->cpu_deltas.resize(std::min<uint64_t>(in.Get(), 4096));
+  for (LinuxParser::CpuTimes& delta : frame->cpu_deltas) {
+    delta.active = long(in.Get());
+    delta.idle = long(in.Get());
+  }
+  long const jiffies =
+      frame->cpu_deltas.empty() ? 0 : frame->cpu_deltas[0].Total();
+  if (!frame->cpu_deltas.empty()) {
+    frame->cpu_utilization = Ratio(frame->cpu_deltas[0].active, jiffies);
+    for (size_t i = 1; i < frame->cpu_deltas.size(); ++i) {
+      frame->core_utilization.push_back(Ratio(
+          frame->cpu_deltas[i].active, frame->cpu_deltas[i].Total()));
+    }
+  }
+  frame->processes.resize(std::min<uint64_t>(in.Get(), 4096));
+  for (ProcessRow& process : frame->processes) {
+    process.pid = int(in.Get());
+    process.user = get_string();
+    process.command = get_string();
+    process.cpu_ticks = in.Get();
+    process.cpu_utilization = Ratio(long(process.cpu_ticks), jiffies);
+    process.ram = long(in.Get());
+    process.uptime = long(in.Get());
+    process.read_rate = double(in.Get()) - 1;
+    process.write_rate = double(in.Get()) - 1;
+    process.depth = int(in.Get());
+    process.tree_ticks = in.Get();
+    process.tree_cpu_utilization = Ratio(long(process.tree_ticks), jiffies);
+    process.tree_ram = long(in.Get());
+  }
+  return frame;
+}
@@ -1,11 +1,19 @@
 #include "linux_parser.h"
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
-#include <iostream>
-#include <filesystem>
+
+#include "user_cache.h"
 using std::stof;
 using std::string;
 using std::to_string;
@@ -16,6 +24,70 @@ using std::istringstream;
 using std::all_of;
 using std::getline;
 
+namespace {
+long const kClockTicks{sysconf(_SC_CLK_TCK)};
+long const kPageSize{sysconf(_SC_PAGESIZE)};
+
+ProcSource const* source{&ProcSource::Live()};
+
+// Reads relative to the current source; path starts with '/', as in "/stat".
+ssize_t ReadFile(char const* path, char* buffer, size_t capacity) {
+  return source->Read(path, buffer, capacity);
+}
+
+ssize_t ReadFile(char const* path, std::vector<char>& buffer) {
+  return source->Read(path, buffer);
+}
+
+// The whole of path as a stream for the line-oriented readers; the stream
+// is in a failed state if path could not be read.
+istringstream ProcStream(string const& path) {
+  static thread_local vector<char> buffer;
+  ssize_t const length = ReadFile(path.c_str(), buffer);
+  istringstream stream(length >= 0 ? string(buffer.data(), size_t(length))
+                                   : string());
+  if (length < 0) stream.setstate(std::ios::failbit);
+  return stream;
+}
+
+// Parse a decimal integer at p, advancing p past it and one separator.
+template <typename T>
+T NextNumber(char const*& p, char const* end) {
+  bool negative{false};
+  if (p < end && *p == '-') {
+    negative = true;
+    ++p;
+  }
+  T value{0};
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value * 10 + T(*p - '0');
+    ++p;
+  }
+  if (p < end) ++p;
+  return negative ? T(0) - value : value;
+}
+
+// Skip any run of spaces at p; for column-aligned files.
+void SkipSpaces(char const*& p, char const* end) {
+  while (p < end && *p == ' ') ++p;
+}
+
+// Copy [begin, end) into a fixed name field, truncating if needed.
+template <size_t N>
+void CopyName(char (&name)[N], char const* begin, char const* end) {
+  size_t const length = std::min(size_t(end - begin), N - 1);
+  memcpy(name, begin, length);
+  name[length] = '\0';
+}
+
+// Skip count space-separated fields starting at p.
+void SkipFields(char const*& p, char const* end, int count) {
+  while (count > 0 && p < end) {
+    if (*p++ == ' ') --count;
+  }
+}
+}  // namespace
+
 // read data from the filesystem
 string LinuxParser::OperatingSystem() {
   string line;
@@ -43,8 +115,8 @@ string LinuxParser::OperatingSystem() {
 string LinuxParser::Kernel() {
   string os, kernel, version;
   string line;
-  ifstream stream(kProcDirectory + kVersionFilename);
-  if (stream.is_open()) {
+  istringstream stream = ProcStream(kVersionFilename);
+  if (!stream.fail()) {
     getline(stream, line);
     istringstream line_stream(line);
     line_stream >> os >> version >> kernel;
@@ -52,55 +124,141 @@ string LinuxParser::Kernel() {
   return kernel; // Return Kernel Version
 }
 
-// BONUS: Update this to use std::filesystem
+// Always the live /proc: this is about the monitor itself.
+long long LinuxParser::ThreadWrittenBytes() {
+  char buffer[512];
+  ssize_t const length =
+      ProcSource::Live().Read("/thread-self/io", buffer, sizeof(buffer));
+  if (length < 0) return -1;
+  char const* end = buffer + length;
+  char const* p = std::strstr(buffer, "wchar: ");
+  if (p == nullptr) return -1;
+  p += 7;
+  return NextNumber<long long>(p, end);
+}
+
 std::vector<int> LinuxParser::Pids() {
   std::vector<int> pids;
-  for (const auto& entry : std::filesystem::directory_iterator(kProcDirectory)) {
-    if (entry.is_directory()) {
-      std::string filename = entry.path().filename().string();
-      if (all_of(filename.begin(), filename.end(), isdigit)) {
-        int pid = std::stoi(filename);
-        pids.push_back(pid);
-      }
-    }
-  }
+  source->Pids(pids);
   return pids;
 }
 
-// Read and return the system memory utilization
-float LinuxParser::MemoryUtilization() {
-  float mem_total = 1.0f, mem_free = 1.0f;
-  ifstream filestream(kProcDirectory + kMeminfoFilename);
+bool LinuxParser::Pids(std::vector<int>& pids) { return source->Pids(pids); }
 
-  if (!filestream.is_open()) {
-    return 0.0f; // Return 0 if the file couldn't be opened.
-  }
+void LinuxParser::SetSource(ProcSource const& proc) { source = &proc; }
 
-  std::string line;
-  while (getline(filestream, line)) {
-    istringstream line_stream(line);
-    std::string key;
-    line_stream >> key;
-
-    if (key == "MemTotal:") {
-      line_stream >> mem_total;
-    } else if (key == "MemFree:") {
-      line_stream >> mem_free;
-      break;
+ProcSource const& LinuxParser::Source() { return *source; }
+
+namespace {
+// The live cgroup v2 root, found on first use.
+ProcSource const& LiveCgroups() {
+  static DirectorySource const live([] {
+    char buffer[16];
+    DirectorySource const unified(LinuxParser::kCgroupRoot);
+    return unified.Read("/cgroup.controllers", buffer, sizeof(buffer)) >= 0
+               ? LinuxParser::kCgroupRoot
+               : LinuxParser::kCgroupHybridRoot;
+  }());
+  return live;
+}
+
+ProcSource const* cgroup_source{nullptr};
+}  // namespace
+
+void LinuxParser::SetCgroupSource(ProcSource const& cgroups) {
+  cgroup_source = &cgroups;
+}
+
+ProcSource const& LinuxParser::CgroupSource() {
+  return cgroup_source != nullptr ? *cgroup_source : LiveCgroups();
+}
+
+namespace {
+// Keys of /proc/meminfo, with the colon, and where each value goes. Lines
+// are matched on length first so most are rejected without a compare.
+struct MemInfoKey {
+  char const* name;
+  size_t length;
+  unsigned long long LinuxParser::MemInfo::*field;
+};
+
+#define MEMINFO_KEY(name, field) \
+  { name, sizeof(name) - 1, &LinuxParser::MemInfo::field }
+MemInfoKey const kMemInfoKeys[] = {
+    MEMINFO_KEY("MemTotal:", total),
+    MEMINFO_KEY("MemFree:", free),
+    MEMINFO_KEY("MemAvailable:", available),
+    MEMINFO_KEY("Buffers:", buffers),
+    MEMINFO_KEY("Cached:", cached),
+    MEMINFO_KEY("SwapTotal:", swap_total),
+    MEMINFO_KEY("SwapFree:", swap_free),
+    MEMINFO_KEY("Dirty:", dirty),
+    MEMINFO_KEY("Shmem:", shmem),
+    MEMINFO_KEY("Slab:", slab),
+    MEMINFO_KEY("HugePages_Total:", huge_pages_total),
+    MEMINFO_KEY("HugePages_Free:", huge_pages_free),
+    MEMINFO_KEY("Hugepagesize:", huge_page_size),
+};
+#undef MEMINFO_KEY
+}  // namespace
+
+bool LinuxParser::ParseMemInfo(char const* buffer, size_t length,
+                               MemInfo& memory) {
+  memory = MemInfo{};
+  bool has_available{false};
+  size_t found{0};
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end && found < std::size(kMemInfoKeys)) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    char const* const colon =
+        static_cast<char const*>(memchr(p, ':', line_end - p));
+    if (colon != nullptr) {
+      size_t const key_length = size_t(colon - p) + 1;
+      for (MemInfoKey const& key : kMemInfoKeys) {
+        if (key.length != key_length || memcmp(p, key.name, key_length) != 0) {
+          continue;
+        }
+        char const* value = colon + 1;
+        while (value < line_end && *value == ' ') ++value;
+        memory.*key.field = NextNumber<unsigned long long>(value, line_end);
+        has_available |= key.field == &MemInfo::available;
+        ++found;
+        break;
+      }
     }
+    p = line_end + 1;
   }
-
-  if (mem_total == 0.0f) {
-    return 0.0f; // Avoid division by zero.
+  // Kernels before 3.14 have no MemAvailable; approximate it the way free(1)
+  // used to.
+  if (!has_available) {
+    memory.available = memory.free + memory.buffers + memory.cached;
   }
+  return memory.total > 0;
+}
 
-  return (mem_total - mem_free) / mem_total;
+bool LinuxParser::ReadMemInfo(MemInfo& memory) {
+  char buffer[8192];
+  static string const path = kMeminfoFilename;
+  ssize_t const length = ReadFile(path.c_str(), buffer, sizeof(buffer));
+  return length > 0 && ParseMemInfo(buffer, size_t(length), memory);
+}
+
+// Read and return the system memory utilization
+float LinuxParser::MemoryUtilization() {
+  MemInfo memory;
+  if (!ReadMemInfo(memory)) {
+    return 0.0f;
+  }
+  return memory.Utilization();
 }
 
 //  Read and return the system uptime
 long LinuxParser::UpTime() {
-  ifstream filestream(kProcDirectory + kUptimeFilename);
-  if (filestream.is_open()) {
+  istringstream filestream = ProcStream(kUptimeFilename);
+  if (!filestream.fail()) {
     long system_uptime;
     filestream >> system_uptime;
     return system_uptime;
@@ -116,31 +274,14 @@ long LinuxParser::Jiffies() {
 
 //  Read and return the number of active jiffies for a PID
 
-long LinuxParser::ActiveJiffies(int pid ) {
-  long total_time{0};
-  string line, value;
-  vector<string> values;
-  ifstream filestream(kProcDirectory + to_string(pid) + kStatFilename);
-  if(filestream.is_open()){
-    getline(filestream, line);
-    istringstream basic_string_stream(line);
-        while(basic_string_stream >> value){
-          values.push_back(value);
-        }
+long LinuxParser::ActiveJiffies(int pid) {
+  ProcStat stat;
+  if (!ReadProcStat(pid, stat)) {
+    return 0;
   }
-  long up_time{0}, system_time{0}, cutime{0}, cstime{0};
-
-  up_time = std::stol(values[13]);
-
-  system_time = std::stol(values[14]);
-
-  cutime = std::stol(values[15]);
-
-  cstime = std::stol(values[16]);
-
-  total_time = up_time + system_time + cutime + cstime;
-
-  return total_time/ sysconf(_SC_CLK_TCK);
+  long const total_time = long(stat.utime + stat.stime) + stat.cutime +
+                          stat.cstime;
+  return total_time / kClockTicks;
 }
 
 //  Read and return the number of active jiffies for the system
@@ -160,8 +301,8 @@ long LinuxParser::IdleJiffies() {
 
 //  Read and return CPU utilization
 vector<std::string> LinuxParser::CpuUtilization() {
-  ifstream filestream(kProcDirectory + kStatFilename);
-  if (!filestream.is_open()) {
+  istringstream filestream = ProcStream(kStatFilename);
+  if (!!filestream.fail()) {
         return {};  // Return an empty vector to indicate an error if
                     // the file couldn't be opened.
   }
@@ -180,11 +321,97 @@ vector<std::string> LinuxParser::CpuUtilization() {
   return values;
 }
 
+// Parse every cpu line at the top of /proc/stat without building strings.
+bool LinuxParser::ParseCpuTimes(char const* buffer, size_t length,
+                                vector<CpuTimes>& cpus) {
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  size_t count{0};
+  while (end - p > 3 && p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+    p += 3;
+    size_t index{0};
+    if (*p != ' ') {
+      index = NextNumber<size_t>(p, end) + 1;
+    }
+    while (p < end && *p == ' ') ++p;
+    long fields[kSteal_ + 1];
+    for (long& field : fields) field = NextNumber<long>(p, end);
+    if (index >= cpus.size()) cpus.resize(index + 1);
+    CpuTimes& cpu = cpus[index];
+    cpu.active = fields[kUser_] + fields[kNice_] + fields[kSystem_] +
+                 fields[kIRQ_] + fields[kSoftIRQ_] + fields[kSteal_];
+    cpu.idle = fields[kIdle_] + fields[kIOwait_];
+    count = std::max(count, index + 1);
+    // Skip guest fields and the newline.
+    char const* const eol = static_cast<char const*>(memchr(p, '\n', end - p));
+    p = eol != nullptr ? eol + 1 : end;
+  }
+  cpus.resize(count);
+  return count > 0;
+}
+
+// Parse the cpu lines, then pick the counters out of the remaining lines by
+// key. The long intr and softirq lines are skipped after their first number.
+bool LinuxParser::ParseSystemStat(char const* buffer, size_t length,
+                                  SystemStatSnapshot& snapshot) {
+  if (!ParseCpuTimes(buffer, length, snapshot.cpus)) {
+    return false;
+  }
+  // Keys missing from a short read are 0, not last frame's values. The
+  // cpus vector is kept for its storage.
+  snapshot.interrupts = 0;
+  snapshot.context_switches = 0;
+  snapshot.boot_time = 0;
+  snapshot.processes = 0;
+  snapshot.procs_running = 0;
+  snapshot.procs_blocked = 0;
+  auto has_key = [](char const* p, char const* end, char const* key,
+                    size_t key_length) {
+    return size_t(end - p) > key_length && memcmp(p, key, key_length) == 0 &&
+           p[key_length] == ' ';
+  };
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    if (has_key(p, line_end, "intr", 4)) {
+      p += 5;
+      snapshot.interrupts = NextNumber<unsigned long long>(p, line_end);
+    } else if (has_key(p, line_end, "ctxt", 4)) {
+      p += 5;
+      snapshot.context_switches = NextNumber<unsigned long long>(p, line_end);
+    } else if (has_key(p, line_end, "btime", 5)) {
+      p += 6;
+      snapshot.boot_time = NextNumber<long>(p, line_end);
+    } else if (has_key(p, line_end, "processes", 9)) {
+      p += 10;
+      snapshot.processes = NextNumber<long>(p, line_end);
+    } else if (has_key(p, line_end, "procs_running", 13)) {
+      p += 14;
+      snapshot.procs_running = NextNumber<int>(p, line_end);
+    } else if (has_key(p, line_end, "procs_blocked", 13)) {
+      p += 14;
+      snapshot.procs_blocked = NextNumber<int>(p, line_end);
+    }
+    p = line_end + 1;
+  }
+  return true;
+}
+
+bool LinuxParser::ReadSystemStat(SystemStatSnapshot& snapshot) {
+  static thread_local vector<char> buffer;
+  static string const path = kStatFilename;
+  ssize_t const length = ReadFile(path.c_str(), buffer);
+  return length > 0 && ParseSystemStat(buffer.data(), size_t(length), snapshot);
+}
+
 //  Read and return the total number of processes
 int LinuxParser::TotalProcesses() {
   int total_processes{0};
-  ifstream filestream(kProcDirectory + kStatFilename);
-  if(filestream.is_open()){
+  istringstream filestream = ProcStream(kStatFilename);
+  if(!filestream.fail()){
       string  key, line;
       while(getline(filestream, line)){
       istringstream string_stream(line);
@@ -201,8 +428,8 @@ int LinuxParser::TotalProcesses() {
 //  Read and return the number of running processes
 int LinuxParser::RunningProcesses() {
   int running_processes{0};
-  ifstream filestream(kProcDirectory + kStatFilename);
-  if(filestream.is_open()){
+  istringstream filestream = ProcStream(kStatFilename);
+  if(!filestream.fail()){
     string  key, line;
     while(getline(filestream, line)){
       istringstream basic_string_stream(line);
@@ -219,39 +446,41 @@ int LinuxParser::RunningProcesses() {
 // Read and return the command associated with a process
 string LinuxParser::Command(int pid ) {
   string command;
-  ifstream filestream(kProcDirectory + to_string(pid) + kCmdlineFilename);
-  if(filestream.is_open()){
+  istringstream filestream =
+      ProcStream("/" + to_string(pid) + kCmdlineFilename);
+  if(!filestream.fail()){
     getline(filestream, command);
   }
   return command;
 }
 
 // Read and return the memory used by a process
+// Resident set size in MB, from the second field of statm. Empty for kernel
+// threads, which have no address space.
 string LinuxParser::Ram(int pid) {
-  string ram;
-  long memory{0};
-  ifstream filestream(kProcDirectory + to_string(pid) + kStatusFilename);
-  if(filestream.is_open()){
-    string line, key;
-    while(getline(filestream, line)){
-      istringstream basic_string_stream(line);
-      basic_string_stream >> key;
-      if(key == "VmSize:"){
-        basic_string_stream >> memory;
-        memory = memory/1000;
-        ram = to_string(memory);
-        break;
-      }
-    }
+  char path[64];
+  snprintf(path, sizeof(path), "/%d%s", pid,
+           kStatmFilename.c_str());
+  char buffer[256];
+  ssize_t const length = ReadFile(path, buffer, sizeof(buffer));
+  if (length <= 0) {
+    return string();
   }
-  return ram;
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  unsigned long const size = NextNumber<unsigned long>(p, end);
+  unsigned long const resident = NextNumber<unsigned long>(p, end);
+  if (size == 0) {
+    return string();
+  }
+  return to_string(resident * (unsigned long)(kPageSize / 1024) / 1000);
 }
 
 //  Read and return the user ID associated with a process
 string LinuxParser::Uid(int pid) {
   string line, key, uid;
-  ifstream filestream(kProcDirectory + to_string(pid) + kStatusFilename);
-  if(filestream.is_open()){
+  istringstream filestream = ProcStream("/" + to_string(pid) + kStatusFilename);
+  if(!filestream.fail()){
     while(getline(filestream, line)){
       istringstream basic_string_stream(line);
       basic_string_stream >> key;
@@ -266,41 +495,411 @@ string LinuxParser::Uid(int pid) {
 
 //  Read and return the user associated with a process
 string LinuxParser::User(int pid) {
-  string uid = Uid(pid);
-  string uid_, user, value, line;
-  string name = "";
-  ifstream filestream(kPasswordPath);
-  if(filestream.is_open()){
-    while(getline(filestream, line)){
-      std::replace(line.begin(), line.end(), ':', ' ');
-      istringstream basic_string_stream(line);
-      basic_string_stream >> user >> value >> uid_;
-      if(uid_ == uid){
-        name = user;
-        break;
+  // Empty when the process has exited since it was listed.
+  string const uid = Uid(pid);
+  char* end{nullptr};
+  unsigned long const value = std::strtoul(uid.c_str(), &end, 10);
+  if (uid.empty() || *end != '\0') return string();
+  return UserName(uid_t(value));
+}
+
+// Callers may be on any thread, so the shared cache is locked; System keeps
+// a cache of its own for the scan.
+string LinuxParser::UserName(uid_t uid) {
+  static std::mutex mutex;
+  static UserCache users;
+  std::lock_guard<std::mutex> lock(mutex);
+  users.Refresh();
+  return users.Name(uid);
+}
+
+//  Read and return the uptime of a process
+long LinuxParser::UpTime(int pid) {
+  ProcStat stat;
+  if (!ReadProcStat(pid, stat)) {
+    return 0;
+  }
+  return long(stat.start_time);
+}
+
+// Parse one /proc/<pid>/stat line. comm is taken up to the last ')' so a
+// command containing spaces or parentheses cannot shift the field indices.
+bool LinuxParser::ParseProcStat(char const* buffer, size_t length,
+                                ProcStat& stat) {
+  char const* const end = buffer + length;
+  char const* const open_paren =
+      static_cast<char const*>(memchr(buffer, '(', length));
+  char const* close_paren = end;
+  while (close_paren > buffer && *(close_paren - 1) != ')') --close_paren;
+  if (open_paren == nullptr || close_paren <= open_paren + 1) {
+    return false;
+  }
+  --close_paren;
+  size_t const comm_length = std::min<size_t>(close_paren - open_paren - 1,
+                                              sizeof(stat.comm) - 1);
+  memcpy(stat.comm, open_paren + 1, comm_length);
+  stat.comm[comm_length] = '\0';
+
+  // close_paren + 2 is field 3 (state).
+  char const* p = close_paren + 2;
+  if (p >= end) {
+    return false;
+  }
+  stat.state = *p;
+  p += 2;
+  stat.ppid = NextNumber<int>(p, end);                    // 4
+  SkipFields(p, end, 9);                                  // 5-13
+  stat.utime = NextNumber<unsigned long>(p, end);         // 14
+  stat.stime = NextNumber<unsigned long>(p, end);         // 15
+  stat.cutime = NextNumber<long>(p, end);                 // 16
+  stat.cstime = NextNumber<long>(p, end);                 // 17
+  SkipFields(p, end, 2);                                  // 18-19
+  stat.num_threads = NextNumber<long>(p, end);            // 20
+  SkipFields(p, end, 1);                                  // 21
+  stat.start_time = NextNumber<unsigned long long>(p, end);  // 22
+  stat.vsize = NextNumber<unsigned long>(p, end);         // 23
+  if (p >= end) {
+    return false;  // truncated before rss
+  }
+  stat.rss = NextNumber<long>(p, end);                    // 24
+  return true;
+}
+
+// Read /proc/<pid>/stat into a stack buffer and parse it.
+bool LinuxParser::ReadProcStat(int pid, ProcStat& stat) {
+  char path[64];
+  snprintf(path, sizeof(path), "/%d%s", pid,
+           kStatFilename.c_str());
+  char buffer[1024];
+  ssize_t const length = ReadFile(path, buffer, sizeof(buffer));
+  return length > 0 && ParseProcStat(buffer, size_t(length), stat);
+}
+
+bool LinuxParser::Tasks(int pid, std::vector<int>& tids) {
+  return source->Tasks(pid, tids);
+}
+
+bool LinuxParser::ReadTaskStat(int pid, int tid, ProcStat& stat) {
+  char path[64];
+  snprintf(path, sizeof(path), "/%d/task/%d%s", pid, tid,
+           kStatFilename.c_str());
+  char buffer[1024];
+  ssize_t const length = ReadFile(path, buffer, sizeof(buffer));
+  return length > 0 && ParseProcStat(buffer, size_t(length), stat);
+}
+
+// Read stat, status and cmdline once each and fill in everything the process
+// table needs. Returns false when the process vanished or is a kernel thread
+// (no address space), in which case status and cmdline are not read at all.
+bool LinuxParser::ReadProcessSnapshot(int pid, ProcessSnapshot& snapshot) {
+  snapshot.pid = pid;
+  return ReadProcStat(pid, snapshot.stat) &&
+         ReadProcessIdentity(pid, snapshot);
+}
+
+// Fill in the fields of a snapshot that stay fixed for the life of the
+// process, given that snapshot.stat has already been read.
+bool LinuxParser::ReadProcessIdentity(int pid, ProcessSnapshot& snapshot) {
+  if (snapshot.stat.vsize == 0) {
+    return false;
+  }
+  snapshot.pid = pid;
+  snapshot.uid = 0;
+  snapshot.command.clear();
+
+  // Uid is near the top of status, well inside one page.
+  char path[64];
+  char status[4096];
+  snprintf(path, sizeof(path), "/%d%s", pid, kStatusFilename.c_str());
+  if (ReadFile(path, status, sizeof(status)) < 0) {
+    return false;
+  }
+  if (char const* uid = std::strstr(status, "\nUid:")) {
+    snapshot.uid = uid_t(std::strtoul(uid + 5, nullptr, 10));
+  }
+
+  // Arguments are NUL-separated; show them separated by spaces.
+  static thread_local vector<char> cmdline;
+  snprintf(path, sizeof(path), "/%d%s", pid, kCmdlineFilename.c_str());
+  ssize_t length = ReadFile(path, cmdline);
+  if (length > 0) {
+    while (length > 0 && cmdline[length - 1] == '\0') --length;
+    snapshot.command.assign(cmdline.data(), size_t(length));
+    std::replace(snapshot.command.begin(), snapshot.command.end(), '\0', ' ');
+  }
+  return true;
+}
+
+// smaps_rollup is a header line followed by "Key:   value kB" lines.
+bool LinuxParser::ParseMemoryRollup(char const* buffer, size_t length,
+                                    MemoryRollup& rollup) {
+  rollup = MemoryRollup{};
+  auto value = [](char const* p, char const* end, char const* key,
+                  size_t key_length, unsigned long long& out) {
+    if (size_t(end - p) <= key_length || memcmp(p, key, key_length) != 0) {
+      return false;
+    }
+    p += key_length;
+    while (p < end && *p == ' ') ++p;
+    out = NextNumber<unsigned long long>(p, end);
+    return true;
+  };
+  bool found{false};
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    found |= value(p, line_end, "Rss:", 4, rollup.rss) ||
+             value(p, line_end, "Pss:", 4, rollup.pss) ||
+             value(p, line_end, "Swap:", 5, rollup.swap) ||
+             value(p, line_end, "SwapPss:", 8, rollup.swap_pss);
+    p = line_end + 1;
+  }
+  return found;
+}
+
+bool LinuxParser::ReadMemoryRollup(int pid, MemoryRollup& rollup) {
+  char path[64];
+  snprintf(path, sizeof(path), "/%d%s", pid,
+           kSmapsRollupFilename.c_str());
+  char buffer[2048];
+  ssize_t const length = ReadFile(path, buffer, sizeof(buffer));
+  return length > 0 && ParseMemoryRollup(buffer, size_t(length), rollup);
+}
+
+// Lines are "key: value"; read_bytes and write_bytes are the only ones that
+// start with those words.
+bool LinuxParser::ParseProcIo(char const* buffer, size_t length, ProcIo& io) {
+  io = ProcIo{};
+  int found{0};
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    if (line_end - p > 12 && memcmp(p, "read_bytes: ", 12) == 0) {
+      p += 12;
+      io.read_bytes = NextNumber<unsigned long long>(p, line_end);
+      ++found;
+    } else if (line_end - p > 13 && memcmp(p, "write_bytes: ", 13) == 0) {
+      p += 13;
+      io.write_bytes = NextNumber<unsigned long long>(p, line_end);
+      ++found;
+    }
+    p = line_end + 1;
+  }
+  return found == 2;
+}
+
+bool LinuxParser::ReadProcIo(int pid, ProcIo& io) {
+  char path[64];
+  snprintf(path, sizeof(path), "/%d%s", pid,
+           kIoFilename.c_str());
+  char buffer[512];
+  ssize_t const length = ReadFile(path, buffer, sizeof(buffer));
+  return length > 0 && ParseProcIo(buffer, size_t(length), io);
+}
+
+// "major minor name" and then the counters, all right-aligned with spaces.
+bool LinuxParser::ParseDiskStats(char const* buffer, size_t length,
+                                 vector<DiskStats>& disks) {
+  size_t count{0};
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    SkipSpaces(p, line_end);
+    NextNumber<unsigned>(p, line_end);  // major
+    SkipSpaces(p, line_end);
+    NextNumber<unsigned>(p, line_end);  // minor
+    SkipSpaces(p, line_end);
+    char const* const name = p;
+    while (p < line_end && *p != ' ') ++p;
+    char const* const name_end = p;
+    unsigned long long fields[10]{};
+    for (unsigned long long& field : fields) {
+      SkipSpaces(p, line_end);
+      field = NextNumber<unsigned long long>(p, line_end);
+    }
+    // fields: reads, merged, sectors, ms, writes, merged, sectors, ms,
+    // in flight, io ms.
+    if (name_end > name && (fields[0] != 0 || fields[4] != 0)) {
+      if (count >= disks.size()) disks.resize(count + 1);
+      DiskStats& disk = disks[count++];
+      CopyName(disk.name, name, name_end);
+      disk.reads = fields[0];
+      disk.sectors_read = fields[2];
+      disk.writes = fields[4];
+      disk.sectors_written = fields[6];
+      disk.io_ticks = fields[9];
+    }
+    p = line_end + 1;
+  }
+  disks.resize(count);
+  return true;
+}
+
+bool LinuxParser::ReadDiskStats(vector<DiskStats>& disks) {
+  static thread_local vector<char> buffer;
+  static string const path = kDiskstatsFilename;
+  ssize_t const length = ReadFile(path.c_str(), buffer);
+  return length >= 0 && ParseDiskStats(buffer.data(), size_t(length), disks);
+}
+
+// Two header lines, then "name: " and sixteen counters: eight receive and
+// eight transmit, each set starting with bytes and packets.
+bool LinuxParser::ParseNetDev(char const* buffer, size_t length,
+                              vector<NetDevStats>& interfaces) {
+  size_t count{0};
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  for (int header = 0; header < 2 && p < end; ++header) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    p = eol != nullptr ? eol + 1 : end;
+  }
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    SkipSpaces(p, line_end);
+    char const* const name = p;
+    char const* const colon =
+        static_cast<char const*>(memchr(p, ':', line_end - p));
+    if (colon != nullptr) {
+      p = colon + 1;
+      unsigned long long fields[10]{};
+      for (unsigned long long& field : fields) {
+        SkipSpaces(p, line_end);
+        field = NextNumber<unsigned long long>(p, line_end);
+      }
+      bool const loopback = colon - name == 2 && memcmp(name, "lo", 2) == 0;
+      if (!loopback && (fields[0] != 0 || fields[8] != 0)) {
+        if (count >= interfaces.size()) interfaces.resize(count + 1);
+        NetDevStats& interface = interfaces[count++];
+        CopyName(interface.name, name, colon);
+        interface.rx_bytes = fields[0];
+        interface.rx_packets = fields[1];
+        interface.tx_bytes = fields[8];
+        interface.tx_packets = fields[9];
       }
     }
+    p = line_end + 1;
   }
-  return name;
+  interfaces.resize(count);
+  return true;
 }
 
-//  Read and return the uptime of a process
-long LinuxParser::UpTime(int pid) {
-  string line, value;
-  vector<string> values;
-  long start_time{0};
-  ifstream filestream(kProcDirectory + to_string(pid) + kStatFilename);
-  if(filestream.is_open()){
-    getline(filestream, line);
-    istringstream basic_string_stream(line);
-    while(basic_string_stream >> value){
-      values.push_back(value);
+bool LinuxParser::ReadNetDev(vector<NetDevStats>& interfaces) {
+  static thread_local vector<char> buffer;
+  static string const path = kNetDevFilename;
+  ssize_t const length = ReadFile(path.c_str(), buffer);
+  return length >= 0 &&
+         ParseNetDev(buffer.data(), size_t(length), interfaces);
+}
+
+// One "hierarchy-ID:controllers:path" line per hierarchy; v2 is "0::".
+bool LinuxParser::ParseProcessCgroup(char const* buffer, size_t length,
+                                     string& path) {
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    if (line_end - p > 3 && memcmp(p, "0::", 3) == 0) {
+      path.assign(p + 3, line_end);
+      return true;
     }
+    p = line_end + 1;
   }
-  try {
-    start_time = std::stol(values[21]);
-      } catch (...) {
-    return 0;
+  return false;
+}
+
+bool LinuxParser::ReadProcessCgroup(int pid, string& path) {
+  char file[64];
+  snprintf(file, sizeof(file), "/%d%s", pid, kCgroupFilename.c_str());
+  char buffer[1024];
+  ssize_t const length = ReadFile(file, buffer, sizeof(buffer));
+  return length > 0 && ParseProcessCgroup(buffer, size_t(length), path);
+}
+
+bool LinuxParser::ParseCgroupCpuStat(char const* buffer, size_t length,
+                                     CgroupStats& stats) {
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    if (line_end - p > 11 && memcmp(p, "usage_usec ", 11) == 0) {
+      p += 11;
+      stats.usage_usec = NextNumber<unsigned long long>(p, line_end);
+      return true;
+    }
+    p = line_end + 1;
+  }
+  return false;
+}
+
+// "major:minor rbytes=N wbytes=N rios=N wios=N dbytes=N dios=N" per device.
+bool LinuxParser::ParseCgroupIoStat(char const* buffer, size_t length,
+                                    CgroupStats& stats) {
+  stats.read_bytes = stats.write_bytes = 0;
+  char const* p = buffer;
+  char const* const end = buffer + length;
+  while (p < end) {
+    char const* const eol =
+        static_cast<char const*>(memchr(p, '\n', end - p));
+    char const* const line_end = eol != nullptr ? eol : end;
+    while (p < line_end) {
+      char const* const field = p;
+      while (p < line_end && *p != ' ') ++p;
+      char const* const field_end = p;
+      SkipSpaces(p, line_end);
+      char const* value = field + 7;
+      if (field_end - field > 7 && memcmp(field, "rbytes=", 7) == 0) {
+        stats.read_bytes += NextNumber<unsigned long long>(value, field_end);
+      } else if (field_end - field > 7 && memcmp(field, "wbytes=", 7) == 0) {
+        stats.write_bytes += NextNumber<unsigned long long>(value, field_end);
+      }
+    }
+    p = line_end + 1;
+  }
+  stats.has_io = true;
+  return true;
+}
+
+// cpu.stat is always there; memory.current and io.stat only with their
+// controllers enabled in the parent's cgroup.subtree_control.
+bool LinuxParser::ReadCgroupStats(string const& path, CgroupStats& stats) {
+  ProcSource const& cgroups = CgroupSource();
+  // The root is "/", which must not double the separator.
+  char const* const directory = path == "/" ? "" : path.c_str();
+  char file[512];
+  char buffer[4096];
+  auto read = [&](char const* name) {
+    int const written = snprintf(file, sizeof(file), "%s/%s",
+                                 directory, name);
+    if (written < 0 || size_t(written) >= sizeof(file)) return ssize_t(-1);
+    return cgroups.Read(file, buffer, sizeof(buffer));
+  };
+  stats = CgroupStats{};
+  ssize_t length = read("cpu.stat");
+  if (length <= 0 || !ParseCgroupCpuStat(buffer, size_t(length), stats)) {
+    return false;
+  }
+  length = read("memory.current");
+  if (length > 0) {
+    char const* p = buffer;
+    stats.memory_bytes = NextNumber<long long>(p, buffer + length);
   }
-  return start_time;
+  length = read("io.stat");
+  if (length >= 0) ParseCgroupIoStat(buffer, size_t(length), stats);
+  return true;
 }
@@ -1,7 +1,215 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "collector.h"
+#include "exporter.h"
+#include "history.h"
+#include "linux_parser.h"
 #include "ncurses_display.h"
+#include "proc_source.h"
 #include "system.h"
 
-int main() {
-  System system;
-  NCursesDisplay::Display(system);
-}
\ No newline at end of file
+namespace {
+void Usage(char const* program, std::FILE* out = stderr) {
+  std::fprintf(out,
+               "usage: %s [options]\n"
+               "  --help             print this and exit\n"
+               "  --top=N            process rows per frame (default 10)\n"
+               "  --sort=KEY         cpu (default), mem, pid, start, io, tree\n"
+               "  --workers=N        /proc scan threads (default: auto)\n"
+               "  --pss              also read PSS and swap for listed rows\n"
+               "  --threads=N        list the threads of the first N rows\n"
+               "  --events           follow process events instead of polling\n"
+               "  --headless         write frames instead of the ncurses UI\n"
+               "  --format=FORMAT    jsonl or csv (default jsonl)\n"
+               "  --interval=MS      sampling interval (default 1000)\n"
+               "  --count=N          frames to write, 0 for no limit\n"
+               "  --output=PATH      write to PATH instead of stdout\n"
+               "  --record=PATH      keep a ring of recent frames in PATH\n"
+               "  --history=N        frames kept by --record (default 600)\n"
+               "  --replay=PATH      browse the frames recorded in PATH\n"
+               "  --proc=PATH        read /proc from a directory or tarball\n"
+               "  --cgroups          also list cgroups (the UI starts there)\n"
+               "  --cgroup-root=PATH read cgroups from a directory or tar\n",
+               program);
+}
+
+// Return the value of "--name=value" if arg is that option, else nullptr.
+char const* OptionValue(char const* arg, char const* name) {
+  size_t const length = std::strlen(name);
+  if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+    return arg + length + 1;
+  }
+  return nullptr;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int top{10};
+  int thread_rows{0};
+  SortKey sort_key{SortKey::kCpu};
+  size_t workers{0};
+  bool headless{false};
+  bool memory_detail{false};
+  bool cgroups{false};
+  bool events{false};
+  Exporter::Format format{Exporter::Format::kJsonLines};
+  long interval_ms{1000};
+  unsigned long count{0};
+  std::string output;
+  std::string record;
+  std::string replay;
+  std::string proc;
+  std::string cgroup_root;
+  unsigned long history_frames{600};
+
+  for (int i = 1; i < argc; ++i) {
+    char const* arg = argv[i];
+    char const* value;
+    if (std::strcmp(arg, "--help") == 0) {
+      Usage(argv[0], stdout);
+      return 0;
+    } else if (std::strcmp(arg, "--headless") == 0) {
+      headless = true;
+    } else if (std::strcmp(arg, "--pss") == 0) {
+      memory_detail = true;
+    } else if (std::strcmp(arg, "--cgroups") == 0) {
+      cgroups = true;
+    } else if (std::strcmp(arg, "--events") == 0) {
+      events = true;
+    } else if ((value = OptionValue(arg, "--top"))) {
+      top = std::atoi(value);
+    } else if ((value = OptionValue(arg, "--threads"))) {
+      thread_rows = std::atoi(value);
+    } else if ((value = OptionValue(arg, "--workers"))) {
+      workers = std::strtoul(value, nullptr, 10);
+    } else if ((value = OptionValue(arg, "--interval"))) {
+      interval_ms = std::strtol(value, nullptr, 10);
+    } else if ((value = OptionValue(arg, "--count"))) {
+      count = std::strtoul(value, nullptr, 10);
+    } else if ((value = OptionValue(arg, "--output"))) {
+      output = value;
+    } else if ((value = OptionValue(arg, "--record"))) {
+      record = value;
+    } else if ((value = OptionValue(arg, "--replay"))) {
+      replay = value;
+    } else if ((value = OptionValue(arg, "--proc"))) {
+      proc = value;
+    } else if ((value = OptionValue(arg, "--cgroup-root"))) {
+      cgroup_root = value;
+    } else if ((value = OptionValue(arg, "--history"))) {
+      history_frames = std::strtoul(value, nullptr, 10);
+    } else if ((value = OptionValue(arg, "--format")) &&
+               (std::strcmp(value, "jsonl") == 0 ||
+                std::strcmp(value, "csv") == 0)) {
+      format = value[0] == 'c' ? Exporter::Format::kCsv
+                               : Exporter::Format::kJsonLines;
+    } else if ((value = OptionValue(arg, "--sort")) &&
+               (std::strcmp(value, "cpu") == 0 ||
+                std::strcmp(value, "mem") == 0 ||
+                std::strcmp(value, "pid") == 0 ||
+                std::strcmp(value, "start") == 0 ||
+                std::strcmp(value, "io") == 0 ||
+                std::strcmp(value, "tree") == 0)) {
+      sort_key = value[0] == 'c'   ? SortKey::kCpu
+                 : value[0] == 'm' ? SortKey::kMemory
+                 : value[0] == 'p' ? SortKey::kPid
+                 : value[0] == 'i' ? SortKey::kIo
+                 : value[0] == 't' ? SortKey::kTree
+                                   : SortKey::kStartTime;
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+  if (top < 0 || interval_ms <= 0) {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  std::chrono::milliseconds const interval(interval_ms);
+  if (!replay.empty()) {
+    HistoryReader reader;
+    if (!reader.Open(replay)) {
+      std::fprintf(stderr, "%s: not a history file\n", replay.c_str());
+      return 1;
+    }
+    NCursesDisplay::Replay(reader, top, interval);
+    return 0;
+  }
+
+  // A path ending in .tar is a snapshot, anything else a directory.
+  auto open_source = [](std::string const& path) {
+    std::unique_ptr<ProcSource> source;
+    size_t const length = path.size();
+    if (length > 4 && path.compare(length - 4, 4, ".tar") == 0) {
+      source = SnapshotSource::LoadTar(path);
+    } else {
+      source = std::make_unique<DirectorySource>(path);
+    }
+    return source;
+  };
+  std::unique_ptr<ProcSource> source;
+  if (!proc.empty()) {
+    source = open_source(proc);
+    if (!source) {
+      std::fprintf(stderr, "%s: not a /proc snapshot\n", proc.c_str());
+      return 1;
+    }
+    LinuxParser::SetSource(*source);
+  }
+  std::unique_ptr<ProcSource> cgroup_source;
+  if (!cgroup_root.empty()) {
+    cgroup_source = open_source(cgroup_root);
+    if (!cgroup_source) {
+      std::fprintf(stderr, "%s: not a cgroup snapshot\n",
+                   cgroup_root.c_str());
+      return 1;
+    }
+    LinuxParser::SetCgroupSource(*cgroup_source);
+  }
+
+  HistoryWriter history;
+  if (!record.empty() && !history.Open(record, history_frames, size_t(top))) {
+    std::perror(record.c_str());
+    return 1;
+  }
+  HistoryWriter* recorder = record.empty() ? nullptr : &history;
+
+  System system(workers);
+  system.SetMemoryDetail(memory_detail);
+  // Older kernels want CAP_NET_ADMIN; without events the PID list is
+  // polled as before.
+  if (events && !system.WatchProcessEvents()) {
+    std::fprintf(stderr, "process events unavailable (%s); polling /proc\n",
+                 std::strerror(errno));
+  }
+  if (!headless) {
+    NCursesDisplay::Display(system, top, interval, sort_key, recorder,
+                            cgroups);
+    return 0;
+  }
+
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(nullptr, std::fclose);
+  if (!output.empty()) {
+    file.reset(std::fopen(output.c_str(), "w"));
+    if (!file) {
+      std::perror(output.c_str());
+      return 1;
+    }
+  }
+  Exporter exporter(file ? file.get() : stdout, format);
+  Collector collector(system, interval, top);
+  collector.SetSortKey(sort_key);
+  collector.SetThreadRows(thread_rows);
+  collector.SetCgroups(cgroups);
+  collector.Collect(count, [&](std::shared_ptr<Frame> frame) {
+    exporter.Write(*frame);
+    if (recorder != nullptr) recorder->Record(*frame);
+  });
+}
@@ -2,116 +2,666 @@
 
 #include <curses.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "collector.h"
 #include "format.h"
+#include "linux_parser.h"
 #include "system.h"
 
-using std::string;
-using std::to_string;
-
 // 50 bars uniformly displayed from 0 - 100 %
 // 2% is one bar(|)
-std::string NCursesDisplay::ProgressBar(float percent) {
-  std::string result{"0%"};
+void NCursesDisplay::ProgressBar(float percent, char* out) {
   int size{50};
   float bars{percent * size};
-
+  char* p = out;
+  *p++ = '0';
+  *p++ = '%';
   for (int i{0}; i < size; ++i) {
-    result += i <= bars ? '|' : ' ';
+    *p++ = i <= bars ? '|' : ' ';
   }
+  *p++ = ' ';
 
-  string display{to_string(percent * 100).substr(0, 4)};
-  if (percent < 0.1 || percent == 1.0)
-    display = " " + to_string(percent * 100).substr(0, 3);
-  return result + " " + display + "/100%";
+  char value[64];
+  std::snprintf(value, sizeof(value), "%f", percent * 100);
+  if (percent < 0.1 || percent == 1.0) {
+    *p++ = ' ';
+    p = std::copy_n(value, 3, p);
+  } else {
+    p = std::copy_n(value, 4, p);
+  }
+  std::memcpy(p, "/100%", 6);
 }
 
-void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
+void NCursesDisplay::DisplaySystem(Frame const& frame, DiffWindow& window,
+                                   std::size_t terminal_bytes) {
+  using std::chrono::duration;
+  chtype const bar_color = COLOR_PAIR(1);
+  char line[128];
   int row{0};
-  mvwprintw(window, ++row, 2, ("OS: " + system.OperatingSystem()).c_str());
-  mvwprintw(window, ++row, 2, ("Kernel: " + system.Kernel()).c_str());
-  mvwprintw(window, ++row, 2, "CPU: ");
-  wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.Cpu().Utilization()).c_str());
-  wattroff(window, COLOR_PAIR(1));
-  mvwprintw(window, ++row, 2, "Memory: ");
-  wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.MemoryUtilization()).c_str());
-  wattroff(window, COLOR_PAIR(1));
-  mvwprintw(window, ++row, 2,
-            ("Total Processes: " + to_string(system.TotalProcesses())).c_str());
-  mvwprintw(
-      window, ++row, 2,
-      ("Running Processes: " + to_string(system.RunningProcesses())).c_str());
-  mvwprintw(window, ++row, 2,
-            ("Up Time: " + Format::ElapsedTime(system.UpTime())).c_str());
-  wrefresh(window);
+  auto text_row = [&](char const* label, char const* value) {
+    window.BeginRow(++row);
+    window.Put(2, label);
+    window.Put(2 + int(std::strlen(label)), value);
+    window.EndRow();
+  };
+  text_row("OS: ", frame.operating_system.c_str());
+  text_row("Kernel: ", frame.kernel.c_str());
+  // History graphs sit under each bar, newest sample on the right.
+  char bar[kProgressBarSize + 1];
+  char spark[Frame::History::Capacity() + 1];
+  int const spark_width = std::max(
+      0, std::min(window.Width() - 10, int(Frame::History::Capacity())));
+  auto bar_row = [&](char const* label, float percent) {
+    window.BeginRow(++row);
+    window.Put(2, label);
+    ProgressBar(percent, bar);
+    window.Put(10, bar, bar_color);
+    window.EndRow();
+  };
+  auto bar_rows = [&](char const* label, float percent,
+                      Frame::History const& history) {
+    bar_row(label, percent);
+    window.BeginRow(++row);
+    Sparkline(history, spark_width, spark);
+    window.Put(10, spark, bar_color);
+    window.EndRow();
+  };
+  bar_rows("CPU: ", frame.cpu_utilization, frame.cpu_history);
+  bar_rows("Memory: ", frame.memory_utilization, frame.memory_history);
+  bar_row("Swap: ", frame.swap_utilization);
+  bar_row("Cache: ", frame.cache_utilization);
+  // With process events, also what came and went during the interval.
+  ProcEventCounts const& events = frame.process_events;
+  if (events.active) {
+    std::snprintf(line, sizeof(line),
+                  "%d  (%lu forks, %lu exits, %lu short-lived)",
+                  frame.total_processes, events.forks, events.exits,
+                  events.short_lived);
+  } else {
+    std::snprintf(line, sizeof(line), "%d", frame.total_processes);
+  }
+  text_row("Total Processes: ", line);
+  std::snprintf(line, sizeof(line), "%d", frame.running_processes);
+  text_row("Running Processes: ", line);
+  Format::ElapsedTime(frame.uptime, line, sizeof(line));
+  text_row("Up Time: ", line);
+  std::snprintf(line, sizeof(line),
+                "%.1f ms collect, %+.1f ms jitter, %zu B drawn",
+                duration<double, std::milli>(frame.collection_time).count(),
+                duration<double, std::milli>(frame.jitter).count(),
+                terminal_bytes);
+  text_row("Sample: ", line);
+}
+
+// Per-core bars, laid out as a grid of "NNN[||||  ]" cells.
+int const kCoreCellWidth{12};
+int const kCoreBarWidth{6};
+int const kMaxCoreRows{8};
+
+int NCursesDisplay::CoreGridRows(int cores, int width) {
+  int const columns = std::max(1, (width - 4) / kCoreCellWidth);
+  return std::min((cores + columns - 1) / columns, kMaxCoreRows);
+}
+
+// When the grid is too small for every core, the last cell shows the
+// average of the rest as "+N[|||   ]".
+void NCursesDisplay::DisplayCores(Frame const& frame, DiffWindow& window) {
+  int const columns = std::max(1, (window.Width() - 2) / kCoreCellWidth);
+  int const rows = std::max(1, getmaxy(window.Window()) - 2);
+  int const cores = int(frame.core_utilization.size());
+  int const cells = std::min(cores, rows * columns);
+  char cell[kCoreCellWidth + 1];
+  for (int core = 0; core < cells; ++core) {
+    if (core % columns == 0) window.BeginRow(1 + core / columns);
+    float utilization = frame.core_utilization[core];
+    int length{0};
+    if (core == cells - 1 && cells < cores) {
+      for (int rest = core + 1; rest < cores; ++rest) {
+        utilization += frame.core_utilization[rest];
+      }
+      utilization /= float(cores - core);
+      length = snprintf(cell, sizeof(cell), "+%2d[",
+                        std::min(cores - core, 999));
+    } else {
+      length = snprintf(cell, sizeof(cell), "%3d[", core);
+    }
+    int const bars = int(utilization * kCoreBarWidth + 0.5f);
+    for (int i = 0; i < kCoreBarWidth; ++i) {
+      cell[length++] = i < bars ? '|' : ' ';
+    }
+    cell[length++] = ']';
+    cell[length] = '\0';
+    window.Put(2 + (core % columns) * kCoreCellWidth, cell);
+    if (core % columns == columns - 1 || core == cells - 1) window.EndRow();
+  }
 }
 
-void NCursesDisplay::DisplayProcesses(std::vector<Process>& processes,
-                                      WINDOW* window, int n) {
+int const kMaxDeviceRows{4};
+
+int NCursesDisplay::DeviceRows(Frame const& frame) {
+  int const devices =
+      int(std::max(frame.disks.size(), frame.interfaces.size()));
+  return std::max(1, std::min(devices, kMaxDeviceRows));
+}
+
+void NCursesDisplay::DisplayDevices(Frame const& frame, DiffWindow& window,
+                                    int rows) {
+  chtype const header_color = COLOR_PAIR(2);
+  int const disk_column{2};
+  int const net_column{std::max(disk_column + 56, window.Width() / 2 + 1)};
+  // Field offsets within each half.
+  int const kOffsets[] = {0, 12, 21, 30, 39, 48};
+  char field[32];
+  auto put_bytes = [&](int column, double bytes) {
+    Format::Bytes(bytes, field, sizeof(field));
+    window.Put(column, field);
+  };
+  auto put_count = [&](int column, double count) {
+    std::snprintf(field, sizeof(field), "%.0f", count);
+    window.Put(column, field);
+  };
+
+  window.BeginRow(1);
+  char const* const disk_titles[] = {"DISK", "R/s", "W/s", "READ/s",
+                                     "WRITE/s", "UTIL%"};
+  char const* const net_titles[] = {"NET", "RX/s", "TX/s", "RXPK/s",
+                                    "TXPK/s"};
+  for (int i = 0; i < 6; ++i) {
+    window.Put(disk_column + kOffsets[i], disk_titles[i], header_color);
+  }
+  for (int i = 0; i < 5; ++i) {
+    window.Put(net_column + kOffsets[i], net_titles[i], header_color);
+  }
+  window.EndRow();
+  for (int row = 0; row < rows; ++row) {
+    window.BeginRow(2 + row);
+    if (row < int(frame.disks.size())) {
+      DiskRate const& disk = frame.disks[row];
+      window.Put(disk_column, disk.name.c_str());
+      put_count(disk_column + kOffsets[1], disk.reads);
+      put_count(disk_column + kOffsets[2], disk.writes);
+      put_bytes(disk_column + kOffsets[3], disk.read_bytes);
+      put_bytes(disk_column + kOffsets[4], disk.write_bytes);
+      std::snprintf(field, sizeof(field), "%.1f",
+                    std::min(disk.utilization, 1.0f) * 100);
+      window.Put(disk_column + kOffsets[5], field);
+    }
+    if (row < int(frame.interfaces.size())) {
+      NetRate const& interface = frame.interfaces[row];
+      window.Put(net_column, interface.name.c_str());
+      put_bytes(net_column + kOffsets[1], interface.rx_bytes);
+      put_bytes(net_column + kOffsets[2], interface.tx_bytes);
+      put_count(net_column + kOffsets[3], interface.rx_packets);
+      put_count(net_column + kOffsets[4], interface.tx_packets);
+    }
+    window.EndRow();
+  }
+}
+
+// An expanded process is followed by one row per thread, busiest first,
+// for as long as the n rows last.
+void NCursesDisplay::DisplayProcesses(
+    std::vector<ProcessRow> const& processes, SortKey sort_key,
+    DiffWindow& window, int n, bool sparklines, bool memory_detail,
+    int selected) {
   int row{0};
   int const pid_column{2};
   int const user_column{9};
   int const cpu_column{16};
   int const ram_column{26};
   int const time_column{35};
-  int const command_column{46};
-  wattron(window, COLOR_PAIR(2));
-  mvwprintw(window, ++row, pid_column, "PID");
-  mvwprintw(window, row, user_column, "USER");
-  mvwprintw(window, row, cpu_column, "CPU[%%]");
-  mvwprintw(window, row, ram_column, "RAM[MB]");
-  mvwprintw(window, row, time_column, "TIME+");
-  mvwprintw(window, row, command_column, "COMMAND");
-  wattroff(window, COLOR_PAIR(2));
-  for (int i = 0; i < n; ++i) {
-    // You need to take care of the fact that the cpu utilization has already
-    // been multiplied by 100.
-    //  Clear the line
-    mvwprintw(window, ++row, pid_column,
-              (string(window->_maxx - 2, ' ').c_str()));
-
-    mvwprintw(window, row, pid_column, to_string(processes[i].Pid()).c_str());
-    mvwprintw(window, row, user_column, processes[i].User().c_str());
-    float cpu = processes[i].CpuUtilization() * 100;
-    mvwprintw(window, row, cpu_column, to_string(cpu).substr(0, 4).c_str());
-    mvwprintw(window, row, ram_column, processes[i].Ram().c_str());
-    mvwprintw(window, row, time_column,
-              Format::ElapsedTime(processes[i].UpTime()).c_str());
-    mvwprintw(window, row, command_column,
-              processes[i].Command().substr(0, window->_maxx - 46).c_str());
+  int const read_column{46};
+  int const write_column{55};
+  // Optional columns follow WRITE/s in this order, before the command.
+  int column{64};
+  int const pss_column{column};
+  int const swap_column{column + 9};
+  if (memory_detail) column += 18;
+  int const spark_column{column};
+  int const spark_width{int(Process::CpuHistory::Capacity())};
+  if (sparklines) column += spark_width + 1;
+  int const command_column{column};
+  // The column the rows are sorted by is shown in reverse video.
+  chtype const header_color = COLOR_PAIR(2);
+  auto header = [&](int column, char const* title, bool sorted) {
+    window.Put(column, title, header_color | (sorted ? A_REVERSE : 0));
+  };
+  window.BeginRow(++row);
+  header(pid_column, "PID", sort_key == SortKey::kPid);
+  header(user_column, "USER", false);
+  // A tree shows each process's CPU and memory with its descendants'.
+  bool const tree{sort_key == SortKey::kTree};
+  header(cpu_column, tree ? "SUB CPU%" : "CPU[%]", sort_key == SortKey::kCpu);
+  header(ram_column, tree ? "SUB[MB]" : "RSS[MB]",
+         sort_key == SortKey::kMemory);
+  header(time_column, "TIME+", sort_key == SortKey::kStartTime);
+  header(read_column, "READ/s", sort_key == SortKey::kIo);
+  header(write_column, "WRITE/s", sort_key == SortKey::kIo);
+  if (memory_detail) {
+    header(pss_column, "PSS[MB]", false);
+    header(swap_column, "SWAP[MB]", false);
+  }
+  if (sparklines) header(spark_column, "CPU HISTORY", false);
+  header(command_column, "COMMAND", false);
+  window.EndRow();
+  int const rows = std::min(n, int(processes.size()));
+  char field[64];
+  int const last_row{row + n};
+  for (int i = 0; i < rows && row < last_row; ++i) {
+    ProcessRow const& process = processes[i];
+    window.BeginRow(++row);
+    if (i == selected) window.Put(pid_column - 1, ">", A_BOLD);
+    std::snprintf(field, sizeof(field), "%d", process.pid);
+    window.Put(pid_column, field, i == selected ? A_REVERSE : A_NORMAL);
+    window.Put(user_column, process.user.c_str());
+    // The utilization is a fraction; the column shows percent.
+    std::snprintf(field, sizeof(field), "%f",
+                  (tree ? process.tree_cpu_utilization
+                        : process.cpu_utilization) *
+                      100);
+    field[4] = '\0';
+    window.Put(cpu_column, field);
+    std::snprintf(field, sizeof(field), "%ld",
+                  tree ? process.tree_ram : process.ram);
+    window.Put(ram_column, field);
+    Format::ElapsedTime(process.uptime, field, sizeof(field));
+    window.Put(time_column, field);
+    // io is only readable for processes we may ptrace.
+    auto rate = [&](double value) {
+      if (value < 0) return "-";
+      Format::Bytes(value, field, sizeof(field));
+      return static_cast<char const*>(field);
+    };
+    window.Put(read_column, rate(process.read_rate));
+    window.Put(write_column, rate(process.write_rate));
+    if (memory_detail) {
+      // smaps_rollup can be unreadable even when stat is not.
+      auto megabytes = [&](long value) {
+        if (value < 0) return "-";
+        std::snprintf(field, sizeof(field), "%ld", value);
+        return static_cast<char const*>(field);
+      };
+      window.Put(pss_column, megabytes(process.pss));
+      window.Put(swap_column, megabytes(process.swap));
+    }
+    if (sparklines) {
+      char spark[Process::CpuHistory::Capacity() + 1];
+      Sparkline(process.cpu_history, spark_width, spark);
+      window.Put(spark_column, spark);
+    }
+    // Children are indented under their parent, up to a limit.
+    int const indent{2 * std::min(process.depth, 16)};
+    if (process.depth > 0) window.Put(command_column + indent - 2, "`-");
+    window.Put(command_column + indent + (process.depth > 0 ? 1 : 0),
+               process.command.c_str());
+    window.EndRow();
+
+    for (Process::Thread const& thread : process.threads) {
+      if (row >= last_row) break;
+      window.BeginRow(++row);
+      std::snprintf(field, sizeof(field), "%d", thread.tid);
+      window.Put(pid_column, field, COLOR_PAIR(1));
+      std::snprintf(field, sizeof(field), "%f", thread.cpu_utilization * 100);
+      field[4] = '\0';
+      window.Put(cpu_column, field, COLOR_PAIR(1));
+      std::snprintf(field, sizeof(field), "`- %s", thread.name.c_str());
+      window.Put(command_column, field, COLOR_PAIR(1));
+      window.EndRow();
+    }
+  }
+  // Rows past the end of the list are drawn blank.
+  while (row < last_row) {
+    window.BeginRow(++row);
+    window.EndRow();
   }
 }
 
-void NCursesDisplay::Display(System& system, int n) {
+// Memory is what the cgroup charges, page cache included; the process
+// count includes processes in nested cgroups.
+void NCursesDisplay::DisplayCgroups(std::vector<CgroupRate> const& cgroups,
+                                    SortKey sort_key, DiffWindow& window,
+                                    int n) {
+  int row{0};
+  int const cpu_column{2};
+  int const memory_column{11};
+  int const read_column{21};
+  int const write_column{30};
+  int const processes_column{39};
+  int const path_column{46};
+  chtype const header_color = COLOR_PAIR(2);
+  auto header = [&](int column, char const* title, bool sorted) {
+    window.Put(column, title, header_color | (sorted ? A_REVERSE : 0));
+  };
+  window.BeginRow(++row);
+  header(cpu_column, "CPU[%]", sort_key == SortKey::kCpu);
+  header(memory_column, "MEM[MB]", sort_key == SortKey::kMemory);
+  header(read_column, "READ/s", sort_key == SortKey::kIo);
+  header(write_column, "WRITE/s", sort_key == SortKey::kIo);
+  header(processes_column, "PROCS", false);
+  bool const by_path{sort_key != SortKey::kCpu &&
+                     sort_key != SortKey::kMemory && sort_key != SortKey::kIo};
+  header(path_column, "CGROUP", by_path);
+  window.EndRow();
+  int const rows = std::min(n, int(cgroups.size()));
+  char field[64];
+  for (int i = 0; i < rows; ++i) {
+    CgroupRate const& cgroup = cgroups[i];
+    window.BeginRow(++row);
+    std::snprintf(field, sizeof(field), "%f", cgroup.cpu_utilization * 100);
+    field[4] = '\0';
+    window.Put(cpu_column, field);
+    // Controllers that are not enabled for a cgroup leave its files out.
+    if (cgroup.memory_bytes < 0) {
+      window.Put(memory_column, "-");
+    } else {
+      std::snprintf(field, sizeof(field), "%lld",
+                    cgroup.memory_bytes / 1000000);
+      window.Put(memory_column, field);
+    }
+    auto rate = [&](double value) {
+      if (value < 0) return "-";
+      Format::Bytes(value, field, sizeof(field));
+      return static_cast<char const*>(field);
+    };
+    window.Put(read_column, rate(cgroup.read_bytes));
+    window.Put(write_column, rate(cgroup.write_bytes));
+    std::snprintf(field, sizeof(field), "%d", cgroup.processes);
+    window.Put(processes_column, field);
+    window.Put(path_column, cgroup.path.c_str());
+    window.EndRow();
+  }
+  while (row < n + 1) {
+    window.BeginRow(++row);
+    window.EndRow();
+  }
+}
+
+namespace {
+// The stacked windows every frame is drawn into. Borders are drawn once;
+// frames only rewrite the cells that changed inside them.
+struct Screen {
+  DiffWindow system;
+  DiffWindow cores;
+  DiffWindow devices;
+  DiffWindow processes;
+  int device_rows;
+  int rows;
+  bool sparklines;
+  std::size_t last_frame_bytes;
+  int selected{-1};  // highlighted process row, -1 for none
+  bool cgroups{false};  // cgroup table in place of the process list
+};
+
+// A window that does not fit in the terminal is made a pad instead: drawn
+// into like the others but never shown.
+WINDOW* FitWindow(int height, int width, int y) {
+  WINDOW* window =
+      y + height <= getmaxy(stdscr) ? newwin(height, width, y, 0) : nullptr;
+  return window != nullptr ? window : newpad(height, width);
+}
+
+Screen OpenScreen(int cores, int device_rows, int n) {
   initscr();      // start ncurses
   noecho();       // do not print input values
   cbreak();       // terminate ncurses on ctrl + c
   start_color();  // enable color
+  init_pair(1, COLOR_BLUE, COLOR_BLACK);
+  init_pair(2, COLOR_GREEN, COLOR_BLACK);
+  keypad(stdscr, TRUE);
+  timeout(50);  // poll for keys and new frames every 50 ms
+  // getch() refreshes stdscr; flush it now so it never repaints the blank
+  // screen over the windows, which are only partially redrawn each frame.
+  refresh();
+
+  int const width{std::max(getmaxx(stdscr) - 1, kCoreCellWidth + 4)};
+  int core_rows{NCursesDisplay::CoreGridRows(cores, width)};
+  // In a short terminal give up process rows first, then device rows, then
+  // core rows, keeping at least one of each. If that is not enough, the
+  // device panel, the core grid and then the system summary are hidden so
+  // that the process list stays on screen, and it gets back the rows they
+  // free.
+  int const wanted{n};
+  int excess = 14 + (2 + core_rows) + (3 + device_rows) + (3 + n) -
+               getmaxy(stdscr);
+  for (int* rows : {&n, &device_rows, &core_rows}) {
+    int const cut = std::max(0, std::min(excess, *rows - 1));
+    *rows -= cut;
+    excess -= cut;
+  }
+  bool const show_devices{excess <= 0};
+  if (!show_devices) excess -= 3 + device_rows;
+  bool const show_cores{excess <= 0};
+  if (!show_cores) excess -= 2 + core_rows;
+  bool const show_system{excess <= 0};
+  if (!show_system) excess -= 14;
+  n = std::min(wanted, n - std::min(excess, 0));
+
+  int y{0};
+  auto place = [&y, width](int height, bool shown) {
+    if (!shown) return newpad(height, width);
+    y += height;
+    return FitWindow(height, width, y - height);
+  };
+  WINDOW* system = place(14, show_system);
+  WINDOW* core_window = place(2 + core_rows, show_cores);
+  WINDOW* devices = place(3 + device_rows, show_devices);
+  WINDOW* processes = place(3 + n, true);
+  box(system, 0, 0);
+  box(core_window, 0, 0);
+  box(devices, 0, 0);
+  box(processes, 0, 0);
+  return Screen{DiffWindow(system),  DiffWindow(core_window),
+                DiffWindow(devices), DiffWindow(processes),
+                device_rows,         n,
+                false,               0};
+}
+
+// title, if given, is drawn into the top border of the system window.
+void DrawFrame(Screen& screen, Frame const& frame,
+               char const* title = nullptr) {
+  if (title != nullptr) {
+    box(screen.system.Window(), 0, 0);
+    mvwprintw(screen.system.Window(), 0, 2, " %s ", title);
+  }
+  NCursesDisplay::DisplaySystem(frame, screen.system, screen.last_frame_bytes);
+  NCursesDisplay::DisplayCores(frame, screen.cores);
+  NCursesDisplay::DisplayDevices(frame, screen.devices, screen.device_rows);
+  if (screen.cgroups) {
+    NCursesDisplay::DisplayCgroups(frame.cgroups, frame.sort_key,
+                                   screen.processes, screen.rows);
+  } else {
+    NCursesDisplay::DisplayProcesses(frame.processes, frame.sort_key,
+                                     screen.processes, screen.rows,
+                                     screen.sparklines, frame.memory_detail,
+                                     screen.selected);
+  }
+  wnoutrefresh(screen.system.Window());
+  wnoutrefresh(screen.cores.Window());
+  wnoutrefresh(screen.devices.Window());
+  wnoutrefresh(screen.processes.Window());
+  // ncurses writes to the terminal from this thread, inside doupdate().
+  long long const before = LinuxParser::ThreadWrittenBytes();
+  doupdate();
+  long long const after = LinuxParser::ThreadWrittenBytes();
+  screen.last_frame_bytes =
+      before >= 0 && after >= before ? std::size_t(after - before) : 0;
+}
+}  // namespace
+
+// Collection runs on a background thread; this loop only draws the most
+// recent complete frame, so slow sampling never stalls the screen.
+// Keys c, m, p, t and i sort the process list by CPU, memory, PID, age or
+// disk I/O, and f shows it as a tree; g switches between processes and
+// cgroups, which sort by the same keys; s toggles per-process CPU
+// sparklines; the up and down arrows select a process and Enter or e shows
+// or hides its threads; q quits.
+void NCursesDisplay::Display(System& system, int n,
+                             std::chrono::milliseconds interval,
+                             SortKey sort_key, HistoryWriter* history,
+                             bool cgroups) {
+  Collector collector(system, interval, n);
+  collector.SetSortKey(sort_key);
+  collector.SetCgroups(cgroups);
+  if (history != nullptr) {
+    collector.OnFrame(
+        [history](Frame const& frame) { history->Record(frame); });
+  }
+  // Draw an initial sample, over a short interval, right away; the
+  // collector takes over from here.
+  std::shared_ptr<Frame const> frame = collector.Sample();
+  collector.Start();
+  Screen screen = OpenScreen(int(frame->core_utilization.size()),
+                             NCursesDisplay::DeviceRows(*frame), n);
+  screen.cgroups = cgroups;
+
+  unsigned long drawn{0};
+  bool running{true};
+  while (running) {
+    if (frame->sequence != drawn) {
+      DrawFrame(screen, *frame);
+      drawn = frame->sequence;
+    }
+    switch (getch()) {
+      case 'c':
+        collector.SetSortKey(SortKey::kCpu);
+        break;
+      case 'm':
+        collector.SetSortKey(SortKey::kMemory);
+        break;
+      case 'p':
+        collector.SetSortKey(SortKey::kPid);
+        break;
+      case 't':
+        collector.SetSortKey(SortKey::kStartTime);
+        break;
+      case 'i':
+        collector.SetSortKey(SortKey::kIo);
+        break;
+      case 'f':
+        collector.SetSortKey(SortKey::kTree);
+        break;
+      case 's':
+        screen.sparklines = !screen.sparklines;
+        drawn = 0;
+        break;
+      case 'g':
+        // The table fills in from the next frame on.
+        screen.cgroups = !screen.cgroups;
+        collector.SetCgroups(screen.cgroups);
+        drawn = 0;
+        break;
+      case KEY_UP:
+        screen.selected = std::max(screen.selected - 1, 0);
+        drawn = 0;
+        break;
+      case KEY_DOWN:
+        screen.selected = std::min({screen.selected + 1,
+                                    int(frame->processes.size()) - 1,
+                                    screen.rows - 1});
+        drawn = 0;
+        break;
+      case 'e':
+      case '\n':
+      case KEY_ENTER:
+        // Threads are read from the next frame on.
+        if (screen.selected >= 0 &&
+            screen.selected < int(frame->processes.size())) {
+          collector.ToggleThreads(frame->processes[screen.selected].pid);
+        }
+        break;
+      case 'q':
+        running = false;
+        break;
+    }
+    if (std::shared_ptr<Frame const> latest = collector.Latest()) {
+      frame = std::move(latest);
+    }
+  }
+  endwin();
+}
+
+// Play recorded frames one per interval. Space pauses, the arrow keys step
+// back and forward, Home/End jump to the ends, q quits.
+void NCursesDisplay::Replay(HistoryReader const& history, int n,
+                            std::chrono::milliseconds interval) {
+  size_t const frames = history.Frames();
+  if (frames == 0) return;
+  std::shared_ptr<Frame> first = history.Read(0);
+  int const cores = first ? int(first->core_utilization.size()) : 0;
+  // Device rates are not recorded, so the device panel stays empty.
+  Screen screen = OpenScreen(cores, 1, n);
+  // Recorded frames do not carry history; rebuild the system graphs from
+  // the frames before the one shown.
+  auto with_history = [&history](size_t index) {
+    std::shared_ptr<Frame> frame = history.Read(index);
+    if (!frame) return frame;
+    size_t const first = index + 1 > Frame::History::Capacity()
+                             ? index + 1 - Frame::History::Capacity()
+                             : 0;
+    for (size_t i = first; i < index; ++i) {
+      if (std::shared_ptr<Frame> earlier = history.Read(i)) {
+        frame->cpu_history.Push(earlier->cpu_utilization);
+        frame->memory_history.Push(earlier->memory_utilization);
+      }
+    }
+    frame->cpu_history.Push(frame->cpu_utilization);
+    frame->memory_history.Push(frame->memory_utilization);
+    return frame;
+  };
 
-  int x_max{getmaxx(stdscr)};
-  WINDOW* system_window = newwin(9, x_max - 1, 0, 0);
-  WINDOW* process_window =
-      newwin(3 + n, x_max - 1, system_window->_maxy + 1, 0);
-
-  while (1) {
-    init_pair(1, COLOR_BLUE, COLOR_BLACK);
-    init_pair(2, COLOR_GREEN, COLOR_BLACK);
-    box(system_window, 0, 0);
-    box(process_window, 0, 0);
-    DisplaySystem(system, system_window);
-    DisplayProcesses(system.Processes(), process_window, n);
-    wrefresh(system_window);
-    wrefresh(process_window);
-    refresh();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+  size_t index{0};
+  size_t drawn{frames};
+  bool playing{true};
+  auto next = std::chrono::steady_clock::now() + interval;
+  while (true) {
+    if (index != drawn) {
+      if (std::shared_ptr<Frame> frame = with_history(index)) {
+        char when[32]{};
+        std::time_t const time =
+            std::chrono::system_clock::to_time_t(frame->wall_time);
+        std::tm local;
+        std::strftime(when, sizeof(when), "%F %T",
+                      localtime_r(&time, &local));
+        char title[96];
+        snprintf(title, sizeof(title), "replay %zu/%zu %s%s", index + 1,
+                 frames, when, playing ? "" : " (paused)");
+        DrawFrame(screen, *frame, title);
+      }
+      drawn = index;
+    }
+    int const key = getch();
+    if (key == 'q') break;
+    switch (key) {
+      case ' ':
+        playing = !playing;
+        next = std::chrono::steady_clock::now() + interval;
+        drawn = frames;  // redraw the title
+        break;
+      case KEY_LEFT:
+        if (index > 0) --index;
+        break;
+      case KEY_RIGHT:
+        if (index + 1 < frames) ++index;
+        break;
+      case KEY_HOME:
+        index = 0;
+        break;
+      case KEY_END:
+        index = frames - 1;
+        break;
+    }
+    if (playing && std::chrono::steady_clock::now() >= next) {
+      if (index + 1 < frames) ++index;
+      next += interval;
+    }
   }
   endwin();
 }
@@ -0,0 +1,220 @@
+#include "proc_events.h"
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#include "proc_source.h"
+
+using std::vector;
+
+namespace {
+// Ask the kernel to start or stop sending process events to socket.
+bool SendControl(int socket, proc_cn_mcast_op op) {
+  alignas(nlmsghdr) char request[NLMSG_LENGTH(sizeof(cn_msg) + sizeof(op))]{};
+  auto* header = reinterpret_cast<nlmsghdr*>(request);
+  header->nlmsg_len = sizeof(request);
+  header->nlmsg_type = NLMSG_DONE;
+  auto* message = static_cast<cn_msg*>(NLMSG_DATA(header));
+  message->id.idx = CN_IDX_PROC;
+  message->id.val = CN_VAL_PROC;
+  message->len = sizeof(op);
+  std::memcpy(message->data, &op, sizeof(op));
+  return send(socket, request, sizeof(request), 0) == ssize_t(sizeof(request));
+}
+
+// Call f with each process event in one datagram.
+template <typename F>
+void ForEachEvent(char const* data, size_t length, F const& f) {
+  int remaining = int(length);
+  for (auto const* header = reinterpret_cast<nlmsghdr const*>(data);
+       NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+    if (header->nlmsg_type == NLMSG_ERROR ||
+        header->nlmsg_type == NLMSG_NOOP ||
+        header->nlmsg_len < NLMSG_LENGTH(sizeof(cn_msg))) {
+      continue;
+    }
+    auto const* message = static_cast<cn_msg const*>(NLMSG_DATA(header));
+    if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC ||
+        message->len < sizeof(proc_event) ||
+        header->nlmsg_len < NLMSG_LENGTH(sizeof(cn_msg) + message->len)) {
+      continue;
+    }
+    // The payload is only byte-aligned.
+    proc_event event;
+    std::memcpy(&event, message->data, sizeof(event));
+    f(event);
+  }
+}
+}  // namespace
+
+ProcEvents::~ProcEvents() { Stop(); }
+
+bool ProcEvents::Start() {
+  if (socket_ >= 0) return true;
+  int const fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC,
+                        NETLINK_CONNECTOR);
+  if (fd < 0) return false;
+  // Bursts of forks arrive faster than a frame; room for about 30k events.
+  int const buffer_size{1 << 21};
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+  sockaddr_nl address{};
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = CN_IDX_PROC;
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      !SendControl(fd, PROC_CN_MCAST_LISTEN)) {
+    int const error = errno;
+    close(fd);
+    errno = error;
+    return false;
+  }
+  // The kernel acknowledges the request, with EPERM when it requires
+  // CAP_NET_ADMIN (older kernels do); events already arriving are covered
+  // by the seed below.
+  int error{ETIMEDOUT};
+  alignas(nlmsghdr) char buffer[8192];
+  pollfd ready{fd, POLLIN, 0};
+  while (error == ETIMEDOUT && poll(&ready, 1, 1000) > 0) {
+    ssize_t const length = recv(fd, buffer, sizeof(buffer), 0);
+    if (length < 0) {
+      if (errno == EINTR || errno == ENOBUFS) continue;
+      error = errno;
+      break;
+    }
+    ForEachEvent(buffer, size_t(length), [&error](proc_event const& event) {
+      if (event.what == proc_event::PROC_EVENT_NONE) {
+        error = int(event.event_data.ack.err);
+      }
+    });
+  }
+  if (error != 0) {
+    close(fd);
+    errno = error;
+    return false;
+  }
+
+  socket_ = fd;
+  ProcSource::Live().Pids(scan_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_.clear();
+    for (int pid : scan_) live_.emplace(pid, 0);
+    counts_ = ProcEventCounts{};
+    counts_.active = true;
+    short_lived_.clear();
+    lost_ = false;
+  }
+  stopping_ = false;
+  thread_ = std::thread(&ProcEvents::Run, this);
+  return true;
+}
+
+void ProcEvents::Stop() {
+  if (socket_ < 0) return;
+  stopping_ = true;
+  if (thread_.joinable()) thread_.join();
+  SendControl(socket_, PROC_CN_MCAST_IGNORE);
+  close(socket_);
+  socket_ = -1;
+}
+
+bool ProcEvents::Active() const { return socket_ >= 0; }
+
+// Wake up now and then to notice Stop(); events wait in the socket.
+void ProcEvents::Run() {
+  alignas(nlmsghdr) char buffer[8192];
+  pollfd ready{socket_, POLLIN, 0};
+  while (!stopping_) {
+    if (poll(&ready, 1, 200) <= 0) continue;
+    ssize_t const length = recv(socket_, buffer, sizeof(buffer), 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (length < 0) {
+      // The socket overflowed: the set is stale until the next rescan.
+      if (errno == ENOBUFS) lost_ = true;
+      continue;
+    }
+    Apply(buffer, size_t(length));
+  }
+}
+
+void ProcEvents::Apply(char const* data, size_t length) {
+  ForEachEvent(data, length, [this](proc_event const& event) {
+    switch (event.what) {
+      case proc_event::PROC_EVENT_FORK: {
+        auto const& fork = event.event_data.fork;
+        // A new thread shares its parent's thread group.
+        if (fork.child_pid != fork.child_tgid) break;
+        live_[fork.child_tgid] = listing_;
+        ++counts_.forks;
+        break;
+      }
+      case proc_event::PROC_EVENT_EXEC:
+        if (event.event_data.exec.process_pid ==
+            event.event_data.exec.process_tgid) {
+          ++counts_.execs;
+        }
+        break;
+      case proc_event::PROC_EVENT_EXIT: {
+        auto const& exit = event.event_data.exit;
+        if (exit.process_pid != exit.process_tgid) break;
+        auto const found = live_.find(exit.process_tgid);
+        if (found != live_.end()) {
+          if (found->second == listing_) {
+            ++counts_.short_lived;
+            short_lived_.push_back(exit.process_tgid);
+          }
+          live_.erase(found);
+        }
+        ++counts_.exits;
+        break;
+      }
+      default:
+        break;
+    }
+  });
+}
+
+// After lost events only /proc knows which processes exist. Processes
+// forked since the last listing are kept; their events were seen.
+void ProcEvents::Resync() {
+  ProcSource::Live().Pids(scan_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto entry = live_.begin(); entry != live_.end();) {
+    entry = entry->second < listing_ ? live_.erase(entry) : std::next(entry);
+  }
+  for (int pid : scan_) live_.try_emplace(pid, 0);
+}
+
+void ProcEvents::Pids(vector<int>& pids, ProcEventCounts& counts,
+                      vector<int>* short_lived) {
+  bool lost;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lost = lost_;
+    lost_ = false;
+  }
+  if (lost) Resync();
+  std::lock_guard<std::mutex> lock(mutex_);
+  pids.clear();
+  pids.reserve(live_.size());
+  for (auto const& entry : live_) pids.push_back(entry.first);
+  counts = counts_;
+  counts_ = ProcEventCounts{};
+  counts_.active = true;
+  if (short_lived != nullptr) short_lived->swap(short_lived_);
+  short_lived_.clear();
+  ++listing_;
+}
+
+void ProcEvents::Forget(int pid) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto const found = live_.find(pid);
+  if (found != live_.end() && found->second < listing_) live_.erase(found);
+}
@@ -0,0 +1,266 @@
+#include "proc_source.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using std::string;
+using std::vector;
+
+namespace {
+// A path's first component, as a PID if it is all digits; 0 if it is not,
+// or too large for an int (a synthetic tree can have any name).
+int LeadingPid(char const* path) {
+  if (*path == '/') ++path;
+  int pid{0};
+  char const* p = path;
+  for (; *p >= '0' && *p <= '9'; ++p) {
+    int const digit = *p - '0';
+    if (pid > (INT_MAX - digit) / 10) return 0;
+    pid = pid * 10 + digit;
+  }
+  return p > path && (*p == '/' || *p == '\0') ? pid : 0;
+}
+}  // namespace
+
+ProcSource const& ProcSource::Live() {
+  static DirectorySource const live("/proc");
+  return live;
+}
+
+DirectorySource::DirectorySource(string root) : root_(std::move(root)) {
+  while (!root_.empty() && root_.back() == '/') root_.pop_back();
+}
+
+int DirectorySource::Open(char const* path, int flags) const {
+  char full[512];
+  size_t const length = std::strlen(path);
+  if (root_.size() + length + 1 > sizeof(full)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  std::memcpy(full, root_.data(), root_.size());
+  std::memcpy(full + root_.size(), path, length + 1);
+  return open(full, flags | O_CLOEXEC);
+}
+
+// A single read(2): /proc files are generated whole on the first read.
+ssize_t DirectorySource::Read(char const* path, char* buffer,
+                              size_t capacity) const {
+  int const fd = Open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  ssize_t const length = read(fd, buffer, capacity - 1);
+  int const error = errno;
+  close(fd);
+  if (length < 0) {
+    errno = error;
+    return -1;
+  }
+  buffer[length] = '\0';
+  return length;
+}
+
+ssize_t DirectorySource::Read(char const* path, vector<char>& buffer) const {
+  int const fd = Open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  if (buffer.size() < 4096) buffer.resize(4096);
+  size_t length{0};
+  while (true) {
+    if (length + 1 >= buffer.size()) buffer.resize(buffer.size() * 2);
+    ssize_t const count =
+        read(fd, buffer.data() + length, buffer.size() - length - 1);
+    if (count < 0) {
+      int const error = errno;
+      close(fd);
+      errno = error;
+      return -1;
+    }
+    if (count == 0) break;
+    length += size_t(count);
+  }
+  close(fd);
+  buffer[length] = '\0';
+  return ssize_t(length);
+}
+
+// getdents64 straight into a stack buffer, the names parsed in place: no
+// DIR allocation or per-entry string, and numbers keeps its capacity.
+bool DirectorySource::List(char const* path, vector<int>& numbers) const {
+  // The kernel's linux_dirent64, for the raw syscall; glibc only wraps it
+  // from 2.30 on.
+  struct Entry {
+    std::uint64_t inode;
+    std::int64_t offset;
+    unsigned short length;
+    unsigned char type;
+    char name[];
+  };
+  numbers.clear();
+  int const fd = Open(path, O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return false;
+  }
+  alignas(Entry) char buffer[32768];
+  while (true) {
+    long const length = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+    if (length < 0) {
+      int const error = errno;
+      close(fd);
+      errno = error;
+      return false;
+    }
+    if (length == 0) break;
+    for (long offset = 0; offset < length;) {
+      auto const* entry = reinterpret_cast<Entry const*>(buffer + offset);
+      offset += entry->length;
+      if (entry->type != DT_DIR && entry->type != DT_UNKNOWN) continue;
+      int const number = LeadingPid(entry->name);
+      if (number > 0) numbers.push_back(number);
+    }
+  }
+  close(fd);
+  return true;
+}
+
+bool DirectorySource::Pids(vector<int>& pids) const { return List("", pids); }
+
+bool DirectorySource::Tasks(int pid, vector<int>& tids) const {
+  char path[32];
+  std::snprintf(path, sizeof(path), "/%d/task", pid);
+  return List(path, tids);
+}
+
+namespace {
+// ustar header fields used here; numbers are octal text.
+size_t const kTarBlock{512};
+
+unsigned long long TarNumber(char const* field, size_t size) {
+  unsigned long long value{0};
+  for (size_t i = 0; i < size && field[i] >= '0' && field[i] <= '7'; ++i) {
+    value = value * 8 + unsigned(field[i] - '0');
+  }
+  return value;
+}
+
+string TarField(char const* field, size_t size) {
+  return string(field, strnlen(field, size));
+}
+}  // namespace
+
+std::unique_ptr<SnapshotSource> SnapshotSource::LoadTar(string const& path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open()) {
+    return nullptr;
+  }
+  string const archive{std::istreambuf_iterator<char>(stream),
+                       std::istreambuf_iterator<char>()};
+  auto source = std::make_unique<SnapshotSource>();
+  size_t offset{0};
+  while (offset + kTarBlock <= archive.size()) {
+    char const* const header = archive.data() + offset;
+    if (header[0] == '\0') break;  // end-of-archive blocks
+    if (std::memcmp(header + 257, "ustar", 5) != 0) {
+      return nullptr;
+    }
+    string name = TarField(header, 100);
+    string const prefix = TarField(header + 345, 155);
+    if (!prefix.empty()) name = prefix + "/" + name;
+    size_t const size = size_t(TarNumber(header + 124, 12));
+    char const type = header[156];
+    offset += kTarBlock;
+    if (offset + size > archive.size()) {
+      return nullptr;
+    }
+    if (type == '0' || type == '\0') {
+      if (name.compare(0, 2, "./") == 0) name.erase(0, 2);
+      if (name.empty() || name[0] != '/') name.insert(0, "/");
+      source->Add(std::move(name), archive.substr(offset, size));
+    }
+    offset += (size + kTarBlock - 1) / kTarBlock * kTarBlock;
+  }
+  return source;
+}
+
+// Every process and thread directory has a stat file, so a PID is listed
+// once its "/<pid>/stat" is added and a thread once "/<pid>/task/<tid>/stat"
+// is.
+void SnapshotSource::Add(string path, string contents) {
+  int const pid = LeadingPid(path.c_str());
+  size_t const slash = pid > 0 ? path.find('/', 1) : string::npos;
+  bool const is_stat = path.size() > 5 &&
+                       path.compare(path.size() - 5, 5, "/stat") == 0;
+  int tid{0};
+  if (is_stat && slash != string::npos &&
+      path.compare(slash, 6, "/task/") == 0) {
+    tid = LeadingPid(path.c_str() + slash + 5);
+    if (path.find('/', slash + 6) != path.size() - 5) tid = 0;
+  }
+  bool const is_process_stat = is_stat && slash == path.size() - 5;
+  auto const inserted = files_.insert_or_assign(std::move(path),
+                                                std::move(contents));
+  if (!inserted.second) return;
+  if (is_process_stat) pids_.push_back(pid);
+  if (tid > 0) tasks_[pid].push_back(tid);
+}
+
+string const* SnapshotSource::Find(char const* path) const {
+  auto const found = files_.find(path);
+  if (found == files_.end()) {
+    errno = ENOENT;
+    return nullptr;
+  }
+  return &found->second;
+}
+
+ssize_t SnapshotSource::Read(char const* path, char* buffer,
+                             size_t capacity) const {
+  string const* contents = Find(path);
+  if (contents == nullptr) {
+    return -1;
+  }
+  size_t const length = std::min(contents->size(), capacity - 1);
+  std::memcpy(buffer, contents->data(), length);
+  buffer[length] = '\0';
+  return ssize_t(length);
+}
+
+ssize_t SnapshotSource::Read(char const* path, vector<char>& buffer) const {
+  string const* contents = Find(path);
+  if (contents == nullptr) {
+    return -1;
+  }
+  if (buffer.size() <= contents->size()) buffer.resize(contents->size() + 1);
+  std::memcpy(buffer.data(), contents->data(), contents->size());
+  buffer[contents->size()] = '\0';
+  return ssize_t(contents->size());
+}
+
+bool SnapshotSource::Pids(vector<int>& pids) const {
+  pids = pids_;
+  return true;
+}
+
+bool SnapshotSource::Tasks(int pid, vector<int>& tids) const {
+  auto const found = tasks_.find(pid);
+  if (found == tasks_.end()) {
+    tids.clear();
+    errno = ENOENT;
+    return false;
+  }
+  tids = found->second;
+  return true;
+}
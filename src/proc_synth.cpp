@@ -0,0 +1,254 @@
+#include "proc_synth.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::string Printf(char const* format, ...)
+    __attribute__((format(printf, 1, 2)));
+std::string Printf(char const* format, ...) {
+  char buffer[1024];
+  va_list arguments;
+  va_start(arguments, format);
+  int length = std::vsnprintf(buffer, sizeof(buffer), format, arguments);
+  va_end(arguments);
+  length = std::min(std::max(length, 0), int(sizeof(buffer)) - 1);
+  return std::string(buffer, size_t(length));
+}
+
+// The cgroup of the user process at index: about twenty processes share
+// each leaf, half of them systemd services and half pod containers.
+std::string Cgroup(int index, int pids) {
+  int const leaves = std::max(1, pids / 20);
+  int const leaf = (index / 7) % leaves;
+  if (leaf % 2 == 0) return Printf("/system.slice/svc%d.service", leaf / 2);
+  return Printf("/kubepods.slice/pod%d/ctr%d", leaf / 4, leaf / 2 % 2);
+}
+}  // namespace
+
+bool ProcSynth::Synthesize(Sink const& out, int pids, int cpus,
+                          unsigned seed) {
+  std::mt19937 random(seed);
+  auto uniform = [&random](unsigned long low, unsigned long high) {
+    return std::uniform_int_distribution<unsigned long>(low, high)(random);
+  };
+  long const uptime{864000};  // ten days
+  long const ticks{sysconf(_SC_CLK_TCK)};
+
+  std::string stat;
+  unsigned long total[4]{};
+  std::string lines;
+  for (int cpu = 0; cpu < cpus; ++cpu) {
+    unsigned long const user = uniform(1000000, 5000000);
+    unsigned long const system = uniform(200000, 1000000);
+    unsigned long const idle = uptime * ticks - user - system;
+    unsigned long const iowait = uniform(1000, 50000);
+    total[0] += user;
+    total[1] += system;
+    total[2] += idle;
+    total[3] += iowait;
+    lines += Printf("cpu%d %lu 0 %lu %lu %lu 0 0 0 0 0\n", cpu, user, system,
+                    idle, iowait);
+  }
+  stat = Printf("cpu  %lu 0 %lu %lu %lu 0 0 0 0 0\n", total[0], total[1],
+                total[2], total[3]) +
+         lines +
+         Printf("intr 123456789 0\nctxt 987654321\nbtime 1700000000\n"
+                "processes %d\nprocs_running %d\nprocs_blocked 0\n",
+                pids * 4, std::max(1, pids / 100));
+  bool ok = out("/stat", stat);
+  ok = ok && out("/uptime",
+                 Printf("%ld.00 %ld.00\n", uptime, uptime * cpus / 2));
+  ok = ok && out("/version",
+                 "Linux version 6.1.0-synthetic (procfake) #1 SMP\n");
+  ok = ok && out("/meminfo",
+                 "MemTotal:       65536000 kB\n"
+                 "MemFree:        12000000 kB\n"
+                 "MemAvailable:   40000000 kB\n"
+                 "Buffers:          500000 kB\n"
+                 "Cached:         26000000 kB\n"
+                 "SwapCached:            0 kB\n"
+                 "SwapTotal:       8388604 kB\n"
+                 "SwapFree:        8000000 kB\n"
+                 "Dirty:             20000 kB\n"
+                 "Shmem:            300000 kB\n"
+                 "Slab:            1500000 kB\n"
+                 "HugePages_Total:       0\n"
+                 "HugePages_Free:        0\n"
+                 "Hugepagesize:       2048 kB\n");
+  ok = ok && out("/diskstats",
+                 " 259       0 nvme0n1 812345 1200 91234567 400000 "
+                 "1623456 45000 182345678 900000 0 700000 1300000 0 0 "
+                 "0 0 0 0\n");
+  ok = ok && out("/net/dev",
+                 "Inter-|   Receive                            "
+                 "                    |  Transmit\n"
+                 " face |bytes    packets errs drop fifo frame "
+                 "compressed multicast|bytes    packets errs drop fifo "
+                 "colls carrier compressed\n"
+                 "    lo: 1000 10 0 0 0 0 0 0 1000 10 0 0 0 0 0 0\n"
+                 "  eth0: 98765432100 87654321 0 0 0 0 0 0 12345678900 "
+                 "23456789 0 0 0 0 0 0\n");
+
+  // Each command with the range of its thread count.
+  struct Command {
+    char const* cmdline;
+    unsigned long min_threads;
+    unsigned long max_threads;
+  };
+  static Command const kCommands[] = {
+      {"/usr/sbin/nginx: worker process", 1, 2},
+      {"/usr/bin/python3 -m worker --queue", 1, 4},
+      {"/usr/lib/jvm/bin/java -Xmx4g -jar service.jar", 16, 48},
+      {"/usr/bin/bash", 1, 1},
+      {"/usr/local/bin/envoy --config /etc/envoy.yaml", 4, 16}};
+  static char const* const kKernelThreads[] = {"kworker/0:1", "ksoftirqd/0",
+                                               "rcu_sched", "kswapd0"};
+  static char const* const kThreadNames[] = {"worker", "GC Thread", "epoll",
+                                             "timer", "io"};
+  static unsigned const kUids[] = {0, 33, 1000, 1001, 65534};
+  // Thread IDs share the PID space but are not listed in the root.
+  int next_tid{100 + pids};
+  // User processes become children of an earlier one half of the time, so
+  // the tree has depth; the rest hang off init, kernel threads off kthreadd.
+  std::vector<int> parents;
+  for (int i = 0; ok && i < pids; ++i) {
+    int const pid = 100 + i;
+    std::string const base = "/" + std::to_string(pid);
+    bool const kernel = uniform(0, 7) == 0;
+    Command const& process = kCommands[uniform(0, 4)];
+    char const* const command =
+        kernel ? kKernelThreads[uniform(0, 3)] : process.cmdline;
+    std::string comm(command, std::strcspn(command, " :"));
+    comm = comm.substr(comm.rfind('/') + 1).substr(0, 15);
+    unsigned long const start = uniform(100, (uptime - 60) * ticks);
+    unsigned long const vsize = kernel ? 0 : uniform(10, 8000) << 20;
+    unsigned long const rss = kernel ? 0 : uniform(100, vsize >> 13);
+    unsigned long const threads =
+        kernel ? 1 : uniform(process.min_threads, process.max_threads);
+    int ppid{kernel ? 2 : 1};
+    if (!kernel) {
+      if (!parents.empty() && uniform(0, 1) == 0) {
+        ppid = parents[uniform(0, parents.size() - 1)];
+      }
+      parents.push_back(pid);
+    }
+    unsigned long const utime = uniform(0, 100000);
+    unsigned long const stime = uniform(0, 20000);
+    auto stat = [&](int id, char const* name, unsigned long share) {
+      return Printf(
+          "%d (%s) %c %d %d %d 0 -1 4194560 1000 0 0 0 %lu %lu 0 0 20 0 %lu 0 "
+          "%lu %lu %lu 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 %lu 0 "
+          "0 0 0 0\n",
+          id, name, uniform(0, 20) == 0 ? 'R' : 'S', ppid, pid, pid,
+          utime / share, stime / share, threads, start, vsize, rss,
+          uniform(0, cpus - 1));
+    };
+    ok = ok && out(base + "/stat", stat(pid, comm.c_str(), 1));
+    // The main thread has the process's ID and name.
+    for (unsigned long t = 0; ok && t < threads; ++t) {
+      int const tid = t == 0 ? pid : next_tid++;
+      char const* const name = t == 0 ? comm.c_str() : kThreadNames[t % 5];
+      ok = out(base + "/task/" + std::to_string(tid) + "/stat",
+               stat(tid, name, threads));
+    }
+    if (kernel) {
+      ok = ok && out(base + "/status",
+                     Printf("Name:\t%s\nState:\tS (sleeping)\n"
+                            "Uid:\t0\t0\t0\t0\n",
+                            comm.c_str()));
+      ok = ok && out(base + "/cmdline", "");
+      ok = ok && out(base + "/cgroup", "0::/\n");
+      continue;
+    }
+    unsigned const uid = kUids[uniform(0, 4)];
+    ok = ok && out(base + "/status",
+                   Printf("Name:\t%s\nUmask:\t0022\nState:\tS "
+                          "(sleeping)\nTgid:\t%d\nPid:\t%d\nPPid:\t%d\n"
+                          "Uid:\t%u\t%u\t%u\t%u\nGid:\t%u\t%u\t%u\t%u\n"
+                          "VmRSS:\t%lu kB\n",
+                          comm.c_str(), pid, pid, ppid, uid, uid, uid, uid,
+                          uid, uid, uid, uid, rss * 4));
+    std::string cmdline = command;
+    for (char& c : cmdline) {
+      if (c == ' ') c = '\0';
+    }
+    cmdline += '\0';
+    ok = ok && out(base + "/cmdline", cmdline);
+    ok = ok && out(base + "/cgroup", "0::" + Cgroup(i, pids) + "\n");
+    ok = ok && out(base + "/statm",
+                   Printf("%lu %lu %lu 1 0 %lu 0\n", vsize >> 12, rss,
+                          rss / 4, rss / 2));
+    ok = ok && out(base + "/io",
+                   Printf("rchar: %lu\nwchar: %lu\nsyscr: 1\nsyscw: 1\n"
+                          "read_bytes: %lu\nwrite_bytes: %lu\n"
+                          "cancelled_write_bytes: 0\n",
+                          uniform(0, 1ul << 32), uniform(0, 1ul << 32),
+                          uniform(0, 1ul << 30), uniform(0, 1ul << 30)));
+  }
+  return ok;
+}
+
+bool ProcSynth::SynthesizeCgroups(Sink const& out, int pids, unsigned seed) {
+  std::mt19937 random(seed);
+  auto uniform = [&random](unsigned long long low, unsigned long long high) {
+    return std::uniform_int_distribution<unsigned long long>(low, high)(
+        random);
+  };
+  struct Counters {
+    unsigned long long usage_usec{0};
+    unsigned long long memory_bytes{0};
+    unsigned long long read_bytes{0};
+    unsigned long long write_bytes{0};
+  };
+  // Leaves first, then every ancestor up to the root gets their sums.
+  std::map<std::string, Counters> cgroups;
+  for (int i = 0; i < pids; ++i) {
+    std::string const leaf = Cgroup(i, pids);
+    if (cgroups.count(leaf) != 0) continue;
+    Counters const counters{uniform(1000000, 86400000000ull),
+                            uniform(1ull << 20, 4ull << 30),
+                            uniform(0, 1ull << 36), uniform(0, 1ull << 36)};
+    std::string path = leaf;
+    for (;;) {
+      Counters& sum = cgroups[path];
+      sum.usage_usec += counters.usage_usec;
+      sum.memory_bytes += counters.memory_bytes;
+      sum.read_bytes += counters.read_bytes;
+      sum.write_bytes += counters.write_bytes;
+      if (path == "/") break;
+      size_t const slash = path.rfind('/');
+      path.resize(slash == 0 ? 1 : slash);
+    }
+  }
+  bool ok{true};
+  for (auto const& [path, counters] : cgroups) {
+    std::string const base = path == "/" ? "" : path;
+    ok = ok && out(base + "/cgroup.controllers", "cpu io memory pids\n");
+    ok = ok && out(base + "/cpu.stat",
+                   Printf("usage_usec %llu\nuser_usec %llu\n"
+                          "system_usec %llu\n",
+                          counters.usage_usec, counters.usage_usec / 4 * 3,
+                          counters.usage_usec / 4));
+    // As on a real host, the root has no memory.current.
+    if (path != "/") {
+      ok = ok && out(base + "/memory.current",
+                     Printf("%llu\n", counters.memory_bytes));
+    }
+    ok = ok && out(base + "/io.stat",
+                   Printf("259:0 rbytes=%llu wbytes=%llu rios=%llu wios=%llu "
+                          "dbytes=0 dios=0\n",
+                          counters.read_bytes, counters.write_bytes,
+                          counters.read_bytes >> 12,
+                          counters.write_bytes >> 12));
+  }
+  return ok;
+}
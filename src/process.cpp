@@ -2,6 +2,7 @@
 #include "linux_parser.h"
 #include <unistd.h>
 
+#include <algorithm>
 #include <cctype>
 #include <sstream>
 #include <string>
@@ -14,39 +15,169 @@ using std::to_string;
 using std::vector;
 
 Process::Process(int pid) : pid_(pid) {
-  pid_ = pid;
-  command_ = LinuxParser::Command(pid_);
-  string ram_str = LinuxParser::Ram(pid_);
-  ram_ = std::stol(ram_str);
-  uptime_ = LinuxParser::UpTime(pid_);
-  user_ = LinuxParser::User(pid_);
-
-  long seconds = LinuxParser::UpTime() - uptime_;
-  long total_time = LinuxParser::ActiveJiffies(pid_);
-  try {
-    cpu_utilization_ = float(total_time) / float(seconds);
-  } catch (...) {
-    cpu_utilization_ = 0.0;
-  }
+  LinuxParser::ProcessSnapshot snapshot;
+  // The snapshot already holds the uid; kernel threads (no snapshot) and
+  // exited processes fall back to status, which gives "" for the latter.
+  string user = LinuxParser::ReadProcessSnapshot(pid, snapshot)
+                    ? LinuxParser::UserName(snapshot.uid)
+                    : LinuxParser::User(pid);
+  *this = Process(snapshot, std::move(user), LinuxParser::UpTime(), 0);
+}
+
+Process::Process(LinuxParser::ProcessSnapshot const& snapshot, string user,
+                 long system_uptime, long jiffies_delta)
+    : pid_(snapshot.pid),
+      start_time_(snapshot.stat.start_time),
+      user_(std::move(user)),
+      command_(snapshot.command) {
+  // A process first seen after the first frame was born during the last
+  // interval, so all of its ticks belong to it. Before that there is no
+  // interval and it starts at 0%.
+  prev_ticks_ =
+      jiffies_delta > 0 ? 0 : snapshot.stat.utime + snapshot.stat.stime;
+  Refresh(snapshot.stat, system_uptime, jiffies_delta);
+}
+
+// CPU utilization is the share of all system jiffies spent in this process
+// since the previous sample, as Processor::Utilization does system-wide.
+void Process::Refresh(LinuxParser::ProcStat const& stat, long system_uptime,
+                      long jiffies_delta) {
+  static long const clock_ticks{sysconf(_SC_CLK_TCK)};
+  static long const page_kb{sysconf(_SC_PAGESIZE) / 1024};
+  ram_kb_ = stat.rss * page_kb;  // resident, as statm reports it
+  ram_ = ram_kb_ / 1000;
+  state_ = stat.state;
+  ppid_ = stat.ppid;
+  uptime_ = system_uptime - long(stat.start_time) / clock_ticks;
+
+  unsigned long const ticks = stat.utime + stat.stime;
+  ticks_delta_ =
+      jiffies_delta > 0 && ticks >= prev_ticks_ ? ticks - prev_ticks_ : 0;
+  cpu_utilization_ =
+      jiffies_delta > 0 ? float(ticks_delta_) / float(jiffies_delta) : 0.0f;
+  if (jiffies_delta > 0) cpu_history_.Push(cpu_utilization_);
+  prev_ticks_ = ticks;
 }
+
 // TODO: Return this process's ID
 int Process::Pid() const {return pid_; }
 
+int Process::PPid() const { return ppid_; }
+
 // TODO: Return this process's CPU utilization
 float Process::CpuUtilization() const { return cpu_utilization_; }
 
+unsigned long Process::CpuTicks() const { return ticks_delta_; }
+
+Process::CpuHistory const& Process::CpuUtilizationHistory() const {
+  return cpu_history_;
+}
+
 // TODO: Return the command that generated this process
 string Process::Command() const { return command_; }
 
 // TODO: Return this process's memory utilization
 string Process::Ram() const { return std::to_string(ram_); }
 
+long Process::RamKb() const { return ram_kb_; }
+
+long Process::PssKb() const { return pss_kb_; }
+
+long Process::SwapKb() const { return swap_kb_; }
+
+void Process::SetMemoryRollup(LinuxParser::MemoryRollup const& rollup) {
+  pss_kb_ = long(rollup.pss);
+  swap_kb_ = long(rollup.swap);
+}
+
+void Process::ClearMemoryRollup() {
+  pss_kb_ = -1;
+  swap_kb_ = -1;
+}
+
+// Like CPU ticks: a process first seen after the first frame was born during
+// the interval, so all of its bytes count towards its first rate. On the
+// first frame seconds is 0 and only the baseline is taken.
+void Process::RefreshIo(LinuxParser::ProcIo const& io, double seconds) {
+  LinuxParser::ProcIo const previous =
+      io_seen_ ? prev_io_ : LinuxParser::ProcIo{};
+  read_rate_ = write_rate_ = 0;
+  if (seconds > 0) {
+    if (io.read_bytes >= previous.read_bytes) {
+      read_rate_ = double(io.read_bytes - previous.read_bytes) / seconds;
+    }
+    if (io.write_bytes >= previous.write_bytes) {
+      write_rate_ = double(io.write_bytes - previous.write_bytes) / seconds;
+    }
+  }
+  prev_io_ = io;
+  io_seen_ = true;
+}
+
+void Process::DenyIo() {
+  io_denied_ = true;
+  read_rate_ = write_rate_ = -1;
+}
+
+bool Process::IoDenied() const { return io_denied_; }
+
+double Process::ReadRate() const { return read_rate_; }
+
+double Process::WriteRate() const { return write_rate_; }
+
+// As for the process: a thread first seen after the baseline started during
+// the interval, so all of its ticks count.
+void Process::RefreshThreads(vector<Thread>& threads, long jiffies_delta,
+                             unsigned long frame) {
+  bool const baseline = threads_frame_ == 0 || threads_frame_ + 1 != frame;
+  std::sort(threads.begin(), threads.end(),
+            [](Thread const& a, Thread const& b) { return a.tid < b.tid; });
+  auto previous = threads_.cbegin();
+  for (Thread& thread : threads) {
+    while (previous != threads_.cend() && previous->tid < thread.tid) {
+      ++previous;
+    }
+    unsigned long const before =
+        previous != threads_.cend() && previous->tid == thread.tid
+            ? previous->ticks
+            : 0;
+    thread.cpu_utilization =
+        !baseline && jiffies_delta > 0 && thread.ticks >= before
+            ? float(thread.ticks - before) / float(jiffies_delta)
+            : 0.0f;
+  }
+  threads_.swap(threads);
+  threads_frame_ = frame;
+}
+
+vector<Process::Thread> const& Process::Threads() const { return threads_; }
+
+bool Process::CgroupStale(std::chrono::steady_clock::time_point now) const {
+  auto const refresh =
+      std::chrono::seconds(10) + std::chrono::milliseconds(pid_ % 1000 * 10);
+  return cgroup_read_at_ == std::chrono::steady_clock::time_point{} ||
+         now - cgroup_read_at_ >= refresh;
+}
+
+string const& Process::Cgroup() const { return cgroup_; }
+
+void Process::SetCgroup(string const& path,
+                        std::chrono::steady_clock::time_point now) {
+  cgroup_.assign(path);
+  cgroup_read_at_ = now;
+}
+
 // TODO: Return the user (name) that generated this process
 string Process::User() const { return user_; }
 
-// TODO: Return the age of this process (in seconds)
+// Return the age of this process (in seconds)
 long int Process::UpTime() const { return uptime_; }
 
+char Process::State() const { return state_; }
+
+// Clock ticks after boot; differs when a PID has been reused.
+unsigned long long Process::StartTime() const { return start_time_; }
+
 // TODO: Overload the "less than" comparison operator for Process objects
 bool Process::operator<(Process const& a [[maybe_unused]]) const {
   return CpuUtilization() < a.CpuUtilization();
@@ -0,0 +1,112 @@
+#include "process_tree.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using std::size_t;
+using std::vector;
+
+namespace {
+// Spreads consecutive PIDs over the table (Fibonacci hashing).
+size_t Slot(int pid, size_t mask) {
+  return size_t(uint32_t(pid) * 2654435769u) & mask;
+}
+}  // namespace
+
+int ProcessTree::Find(int pid) const {
+  size_t const mask = index_.size() - 1;
+  for (size_t slot = Slot(pid, mask);; slot = (slot + 1) & mask) {
+    if (index_[slot].first == pid) return index_[slot].second;
+    if (index_[slot].first == 0) return -1;
+  }
+}
+
+void ProcessTree::Build(vector<Process const*> const& processes, size_t n) {
+  int const nodes = int(processes.size());
+  int const root = nodes;
+  size_t capacity{16};
+  while (capacity < 2 * processes.size()) capacity *= 2;
+  index_.assign(capacity, {0, 0});
+  for (int i = 0; i < nodes; ++i) {
+    int const pid = processes[i]->Pid();
+    size_t slot = Slot(pid, capacity - 1);
+    while (index_[slot].first != 0) slot = (slot + 1) & (capacity - 1);
+    index_[slot] = {pid, i};
+  }
+
+  // Link each node to its parent and count the children of every node.
+  parent_.resize(processes.size());
+  child_begin_.assign(processes.size() + 2, 0);
+  for (int i = 0; i < nodes; ++i) {
+    int const parent = processes[i]->PPid() > 0 ? Find(processes[i]->PPid())
+                                                : -1;
+    parent_[i] = parent >= 0 && parent != i ? parent : root;
+    ++child_begin_[parent_[i] + 1];
+  }
+  for (int i = 0; i <= nodes; ++i) child_begin_[i + 1] += child_begin_[i];
+  // Place the children, using the order array as each range's cursor.
+  children_.resize(processes.size());
+  order_.assign(child_begin_.begin(), child_begin_.end() - 1);
+  for (int i = 0; i < nodes; ++i) children_[order_[parent_[i]]++] = i;
+
+  order_.clear();
+  for (int c = child_begin_[root]; c < child_begin_[root + 1]; ++c) {
+    order_.push_back(children_[c]);
+  }
+  for (size_t k = 0; k < order_.size(); ++k) {
+    int const node = order_[k];
+    for (int c = child_begin_[node]; c < child_begin_[node + 1]; ++c) {
+      order_.push_back(children_[c]);
+    }
+  }
+
+  // Children come after their parents in order_, so walking it backwards
+  // completes every subtree before its total is added to the parent.
+  ticks_.resize(processes.size());
+  cpu_.resize(processes.size());
+  ram_kb_.resize(processes.size());
+  descendants_.assign(processes.size(), 0);
+  for (int i = 0; i < nodes; ++i) {
+    ticks_[i] = processes[i]->CpuTicks();
+    cpu_[i] = processes[i]->CpuUtilization();
+    ram_kb_[i] = processes[i]->RamKb();
+  }
+  for (auto node = order_.rbegin(); node != order_.rend(); ++node) {
+    int const parent = parent_[*node];
+    if (parent == root) continue;
+    ticks_[parent] += ticks_[*node];
+    cpu_[parent] += cpu_[*node];
+    ram_kb_[parent] += ram_kb_[*node];
+    descendants_[parent] += descendants_[*node] + 1;
+  }
+
+  auto const heavier = [this, &processes](int a, int b) {
+    if (ticks_[a] != ticks_[b]) return ticks_[a] > ticks_[b];
+    if (ram_kb_[a] != ram_kb_[b]) return ram_kb_[a] > ram_kb_[b];
+    return processes[a]->Pid() < processes[b]->Pid();
+  };
+  // No more children than rows still to list can be shown, so only that
+  // many are ordered and stacked.
+  auto const push_children = [&](int node, int depth) {
+    int* const begin = children_.data() + child_begin_[node];
+    size_t const count = size_t(child_begin_[node + 1] - child_begin_[node]);
+    int* const end = begin + std::min(count, n - rows_.size());
+    std::partial_sort(begin, end, begin + count, heavier);
+    // Reversed so the heaviest child is popped first.
+    for (int* child = end; child != begin;) {
+      stack_.emplace_back(*--child, depth);
+    }
+  };
+  rows_.clear();
+  stack_.clear();
+  push_children(root, 0);
+  while (!stack_.empty() && rows_.size() < n) {
+    auto const [node, depth] = stack_.back();
+    stack_.pop_back();
+    rows_.push_back({processes[node], depth, ticks_[node], cpu_[node],
+                     ram_kb_[node], descendants_[node]});
+    push_children(node, depth + 1);
+  }
+}
+
+vector<ProcessTree::Row> const& ProcessTree::Rows() const { return rows_; }
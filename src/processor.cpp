@@ -1,38 +1,39 @@
 #include "processor.h"
-#include <sstream>
-#include <linux_parser.h>
-using std::string;
 
-// TODO: Return the aggregate CPU utilization
-float Processor::Utilization() {
- long total_old, total_new , active_new, idle_old, idle_new;
+#include "linux_parser.h"
 
- total_new = CurrentTotal();
- active_new = CurrentActive();
- idle_new = CurrentIdle();
+using std::vector;
 
- total_old = PrevTotal();
- idle_old = PrevIdle();
-
- Update(idle_new, active_new, total_new);
-
- float totalDelta = float(total_new) - float(total_old);
- float idleDelta = float(idle_new) - float(idle_old);
- float utilization = (totalDelta- idleDelta)/ totalDelta;
+float Processor::Utilization() const {
+  return utilization_.empty() ? 0.0f : utilization_[0];
+}
 
- return utilization;
+float Processor::Utilization(int core) const {
+  size_t const index = size_t(core) + 1;
+  return index < utilization_.size() ? utilization_[index] : 0.0f;
+}
 
+int Processor::Cores() const {
+  return utilization_.empty() ? 0 : int(utilization_.size()) - 1;
 }
 
-long Processor::CurrentTotal() {return LinuxParser::Jiffies();}
-long Processor::CurrentActive() {return LinuxParser::ActiveJiffies();}
-long Processor::CurrentIdle() {return LinuxParser::IdleJiffies();}
+vector<LinuxParser::CpuTimes> const& Processor::Deltas() const {
+  return deltas_;
+}
 
-long Processor::PrevTotal() {return total_;}
-long Processor::PrevIdle() {return  idle_;}
-long Processor::PrevActive() {return active_;}
-void Processor::Update(long idle, long active, long total) {
- idle_ = idle;
- active_ = active;
- total_ = total;
+// Compute utilization for every line from the delta against the previous
+// sample, then keep this sample for the next frame.
+void Processor::Update(vector<LinuxParser::CpuTimes> const& times) {
+  prev_.resize(times.size());
+  deltas_.resize(times.size());
+  utilization_.resize(times.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    deltas_[i].active = times[i].active - prev_[i].active;
+    deltas_[i].idle = times[i].idle - prev_[i].idle;
+    float const total_delta = float(deltas_[i].Total());
+    float const idle_delta = float(deltas_[i].idle);
+    utilization_[i] =
+        total_delta > 0 ? (total_delta - idle_delta) / total_delta : 0.0f;
+    prev_[i] = times[i];
+  }
 }
@@ -7,9 +7,11 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <cstddef>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 #include "format.h"
 #include "linux_parser.h"
@@ -26,37 +28,291 @@ system."
 You need to properly format the uptime. Refer to the comments mentioned in
 format. cpp for formatting the uptime.*/
 
+namespace {
+size_t DefaultWorkers() {
+  size_t const hardware = std::thread::hardware_concurrency();
+  return std::max<size_t>(1, std::min(hardware, System::kMaxDefaultWorkers));
+}
+}  // namespace
+
+System::System(size_t workers)
+    : pool_(workers > 0 ? workers : DefaultWorkers()) {}
+
+void System::Update() {
+  auto const now = std::chrono::steady_clock::now();
+  interval_ = updated_at_ != std::chrono::steady_clock::time_point{}
+                  ? std::chrono::duration<double>(now - updated_at_).count()
+                  : 0;
+  updated_at_ = now;
+  ++frame_;
+  LinuxParser::ReadMemInfo(memory_);
+  // A table that cannot be read is emptied, and starts again from a fresh
+  // baseline once it can, rather than holding its last rates.
+  if (!LinuxParser::ReadDiskStats(disk_stats_)) disk_stats_.clear();
+  devices_.UpdateDisks(disk_stats_, interval_);
+  if (!LinuxParser::ReadNetDev(net_stats_)) net_stats_.clear();
+  devices_.UpdateInterfaces(net_stats_, interval_);
+  if (!LinuxParser::ReadSystemStat(stat_)) {
+    return;
+  }
+  cpu_.Update(stat_.cpus);
+  long const jiffies = stat_.cpus[0].Total();
+  jiffies_delta_ = prev_jiffies_ > 0 ? jiffies - prev_jiffies_ : 0;
+  prev_jiffies_ = jiffies;
+}
+
+vector<Process::Thread> const* System::Threads(int pid) {
+  auto const found = table_.find(pid);
+  if (found == table_.end()) return nullptr;
+  Process& process = found->second;
+  threads_.clear();
+  if (LinuxParser::Tasks(pid, tids_)) {
+    LinuxParser::ProcStat stat;
+    for (int tid : tids_) {
+      // Threads exit between the listing and the read.
+      if (!LinuxParser::ReadTaskStat(pid, tid, stat)) continue;
+      threads_.push_back(
+          {tid, stat.comm, stat.state, stat.utime + stat.stime, 0.0f});
+    }
+  }
+  process.RefreshThreads(threads_, jiffies_delta_, frame_);
+  return &process.Threads();
+}
+
 // TODO: Return the system's CPU
 Processor& System::Cpu() { return cpu_; }
 
+DeviceActivity const& System::Devices() const { return devices_; }
+
 // TODO: Return a container composed of the system's processes
-vector<Process>& System::Processes() {
-  vector<int> pids = LinuxParser::Pids();
+bool System::WatchProcessEvents() {
+  if (&LinuxParser::Source() != &ProcSource::Live()) {
+    errno = ENOTSUP;
+    return false;
+  }
+  return events_.Start();
+}
+
+ProcEventCounts const& System::Events() const { return event_counts_; }
+
+vector<Process const*> const& System::Processes(SortKey key, size_t n) {
+  vector<int>& pids = pids_;
+  if (events_.Active()) {
+    events_.Pids(pids, event_counts_);
+  } else {
+    LinuxParser::Pids(pids);
+  }
+  long const system_uptime = LinuxParser::UpTime();
+  long const jiffies_delta = jiffies_delta_;
+  double const interval = interval_;
+  users_.Refresh();
+  // A refused io read is remembered per process so it costs one failed
+  // read per PID rather than one per frame.
+  auto read_io = [](int pid, LinuxParser::ProcIo& io) {
+    errno = 0;
+    if (LinuxParser::ReadProcIo(pid, io)) return ScanSlot::Io::kRead;
+    return errno == EACCES || errno == EPERM ? ScanSlot::Io::kDenied
+                                             : ScanSlot::Io::kFailed;
+  };
+  auto apply_io = [interval](Process& process, ScanSlot::Io state,
+                             LinuxParser::ProcIo const& io) {
+    if (state == ScanSlot::Io::kRead) {
+      process.RefreshIo(io, interval);
+    } else if (state == ScanSlot::Io::kDenied) {
+      process.DenyIo();
+    }
+  };
+
+  // Read every PID's stat on the pool. Each chunk writes only its own slots
+  // and refreshes only the table entries of its own PIDs, so the workers
+  // share nothing; table_ itself is not modified until the merge below.
+  if (scan_.size() < pids.size()) scan_.resize(pids.size());
+  pool_.ParallelFor(pids.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      int const pid = pids[i];
+      ScanSlot& slot = scan_[i];
+      slot.kind = ScanSlot::Kind::kGone;
+      if (!LinuxParser::ReadProcStat(pid, slot.snapshot.stat)) {
+        continue;  // exited since Pids()
+      }
+      // Refresh the entry in place when it is the same process as last
+      // frame; a different start time means the PID was recycled.
+      auto found = table_.find(pid);
+      if (found != table_.end() &&
+          found->second.StartTime() == slot.snapshot.stat.start_time) {
+        Process& process = found->second;
+        process.Refresh(slot.snapshot.stat, system_uptime, jiffies_delta);
+        if (!process.IoDenied()) {
+          apply_io(process, read_io(pid, slot.io), slot.io);
+        }
+        slot.kind = ScanSlot::Kind::kRefreshed;
+      } else if (LinuxParser::ReadProcessIdentity(pid, slot.snapshot)) {
+        slot.io_state = read_io(pid, slot.io);
+        slot.kind = ScanSlot::Kind::kNew;
+      }
+    }
+  });
+
+  // Move survivors' nodes across and build the new entries.
+  next_table_.reserve(pids.size());
+  for (size_t i = 0; i < pids.size(); ++i) {
+    ScanSlot const& slot = scan_[i];
+    if (slot.kind == ScanSlot::Kind::kRefreshed) {
+      next_table_.insert(table_.extract(pids[i]));
+    } else if (slot.kind == ScanSlot::Kind::kNew) {
+      LinuxParser::ProcessSnapshot const& snapshot = slot.snapshot;
+      auto const inserted = next_table_.emplace(
+          pids[i], Process(snapshot, users_.Name(snapshot.uid), system_uptime,
+                           jiffies_delta));
+      apply_io(inserted.first->second, slot.io_state, slot.io);
+    } else if (events_.Active()) {
+      // An exit the events missed, or one still on its way.
+      events_.Forget(pids[i]);
+    }
+  }
+  // Whatever is left in table_ has exited.
+  table_.swap(next_table_);
+  next_table_.clear();
+
   processes_.clear();
-  for (int pid : pids) {
-    if(!LinuxParser::Ram(pid).empty()){
-      Process process(pid);
-      processes_.push_back(process);
+  if (key == SortKey::kTree) {
+    for (auto const& entry : table_) processes_.push_back(&entry.second);
+    tree_.Build(processes_, n);
+    processes_.clear();
+    for (ProcessTree::Row const& row : tree_.Rows()) {
+      processes_.push_back(row.process);
     }
+    ReadMemoryDetail();
+    return processes_;
   }
-  std::sort(processes_.rbegin(), processes_.rend());
+
+  // Select the top n with nth_element and sort only those; larger keys rank
+  // first, with PID as a tie-break so equal rows do not shuffle.
+  ranking_.clear();
+  ranking_.reserve(table_.size());
+  for (auto const& entry : table_) {
+    Process const& process = entry.second;
+    double rank{0};
+    switch (key) {
+      case SortKey::kCpu:
+        rank = process.CpuUtilization();
+        break;
+      case SortKey::kMemory:
+        rank = double(process.RamKb());
+        break;
+      case SortKey::kPid:
+        rank = -double(process.Pid());
+        break;
+      case SortKey::kStartTime:
+        rank = double(process.StartTime());
+        break;
+      case SortKey::kIo:
+        rank = process.ReadRate() + process.WriteRate();
+        break;
+      case SortKey::kTree:
+        break;  // handled above
+    }
+    ranking_.push_back({rank, &process});
+  }
+  auto const higher = [](RankEntry const& a, RankEntry const& b) {
+    return a.key != b.key ? a.key > b.key
+                          : a.process->Pid() < b.process->Pid();
+  };
+  auto const top = ranking_.begin() + std::min(n, ranking_.size());
+  if (top != ranking_.end()) {
+    std::nth_element(ranking_.begin(), top, ranking_.end(), higher);
+  }
+  std::sort(ranking_.begin(), top, higher);
+
+  for (auto entry = ranking_.begin(); entry != top; ++entry) {
+    processes_.push_back(entry->process);
+  }
+  ReadMemoryDetail();
   return processes_;
 }
 
+// The expensive rollup is read only for the rows being returned.
+void System::ReadMemoryDetail() {
+  if (!memory_detail_) return;
+  LinuxParser::MemoryRollup rollup;
+  for (Process const* process : processes_) {
+    Process& entry = table_.at(process->Pid());
+    if (LinuxParser::ReadMemoryRollup(entry.Pid(), rollup)) {
+      entry.SetMemoryRollup(rollup);
+    } else {
+      entry.ClearMemoryRollup();
+    }
+  }
+}
+
+ProcessTree const& System::Tree() const { return tree_; }
+
+vector<CgroupRate const*> const& System::Cgroups(SortKey key, size_t n) {
+  cgroups_.Begin();
+  auto const now = std::chrono::steady_clock::now();
+  for (auto& entry : table_) {
+    Process& process = entry.second;
+    if (process.CgroupStale(now)) {
+      // Unreadable or v1 only: counted nowhere until the next refresh.
+      if (!LinuxParser::ReadProcessCgroup(process.Pid(), cgroup_path_)) {
+        cgroup_path_.clear();
+      }
+      process.SetCgroup(cgroup_path_, now);
+    }
+    if (!process.Cgroup().empty()) cgroups_.Add(process.Cgroup());
+  }
+  cgroups_.Update(cpu_.Cores());
+
+  cgroup_rows_.clear();
+  for (CgroupRate const& cgroup : cgroups_.Cgroups()) {
+    cgroup_rows_.push_back(&cgroup);
+  }
+  auto const rank = [key](CgroupRate const& cgroup) {
+    switch (key) {
+      case SortKey::kCpu:
+        return double(cgroup.cpu_utilization);
+      case SortKey::kMemory:
+        return double(cgroup.memory_bytes);
+      case SortKey::kIo:
+        return cgroup.read_bytes + cgroup.write_bytes;
+      default:
+        return 0.0;
+    }
+  };
+  auto const higher = [&rank](CgroupRate const* a, CgroupRate const* b) {
+    double const a_key = rank(*a);
+    double const b_key = rank(*b);
+    return a_key != b_key ? a_key > b_key : a->path < b->path;
+  };
+  auto const top = cgroup_rows_.begin() + std::min(n, cgroup_rows_.size());
+  std::partial_sort(cgroup_rows_.begin(), top, cgroup_rows_.end(), higher);
+  cgroup_rows_.erase(top, cgroup_rows_.end());
+  return cgroup_rows_;
+}
+
+void System::SetMemoryDetail(bool enabled) { memory_detail_ = enabled; }
+
+bool System::MemoryDetail() const { return memory_detail_; }
+
 // TODO: Return the system's kernel identifier (string)
 std::string System::Kernel() { return LinuxParser::Kernel(); }
 
 // TODO: Return the system's memory utilization
-float System::MemoryUtilization() { return LinuxParser::MemoryUtilization(); }
+float System::MemoryUtilization() { return memory_.Utilization(); }
+
+LinuxParser::MemInfo const& System::Memory() const { return memory_; }
 
 // TODO: Return the operating system name
 std::string System::OperatingSystem() { return LinuxParser::OperatingSystem(); }
 
 // TODO: Return the number of processes actively running on the system
-int System::RunningProcesses() { return LinuxParser::RunningProcesses(); }
+int System::RunningProcesses() { return stat_.procs_running; }
 
 // TODO: Return the total number of processes on the system
-int System::TotalProcesses() { return LinuxParser::TotalProcesses(); }
+int System::TotalProcesses() { return int(stat_.processes); }
+
+// The /proc/stat values read by the last Update()
+LinuxParser::SystemStatSnapshot const& System::Stat() const { return stat_; }
 
 // TODO: Return the number of seconds since the system started running
 long int System::UpTime() { return LinuxParser::UpTime(); }
@@ -0,0 +1,69 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t workers) {
+  for (std::size_t i = 1; i < std::max<std::size_t>(workers, 1); ++i) {
+    threads_.emplace_back(&ThreadPool::Work, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  start_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+std::size_t ThreadPool::Workers() const { return threads_.size() + 1; }
+
+// Chunks are small enough that every worker gets several, which evens out
+// PIDs that are slow to read, but large enough to keep the counter cold.
+void ThreadPool::ParallelFor(
+    std::size_t count,
+    std::function<void(std::size_t, std::size_t)> const& task) {
+  if (count == 0) return;
+  if (threads_.empty()) {
+    task(0, count);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    chunk_ = std::max<std::size_t>(16, count / (Workers() * 8));
+    next_.store(0, std::memory_order_relaxed);
+    busy_ = threads_.size();
+    ++generation_;
+  }
+  start_.notify_all();
+  RunChunks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return busy_ == 0; });
+  task_ = nullptr;
+}
+
+void ThreadPool::RunChunks() {
+  while (true) {
+    std::size_t const begin =
+        next_.fetch_add(chunk_, std::memory_order_relaxed);
+    if (begin >= count_) return;
+    (*task_)(begin, std::min(begin + chunk_, count_));
+  }
+}
+
+void ThreadPool::Work() {
+  unsigned long seen{0};
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+    if (stopping_) return;
+    seen = generation_;
+    lock.unlock();
+    RunChunks();
+    lock.lock();
+    if (--busy_ == 0) done_.notify_one();
+  }
+}
@@ -0,0 +1,70 @@
+#include "user_cache.h"
+
+#include <pwd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::string;
+
+UserCache::UserCache(string path) : path_(std::move(path)) {}
+
+void UserCache::Refresh() {
+  struct stat info;
+  if (stat(path_.c_str(), &info) != 0) {
+    return;
+  }
+  if (loaded_ && info.st_ino == inode_ &&
+      info.st_mtim.tv_sec == mtime_.tv_sec &&
+      info.st_mtim.tv_nsec == mtime_.tv_nsec) {
+    return;
+  }
+  inode_ = info.st_ino;
+  mtime_ = info.st_mtim;
+  Load();
+}
+
+// Each line is name:password:uid:gid:gecos:home:shell. Only the first three
+// fields matter, and they are split on ':' so an empty password field or a
+// GECOS field with spaces cannot shift the columns.
+void UserCache::Load() {
+  names_.clear();
+  loaded_ = true;
+  std::ifstream filestream(path_);
+  string line;
+  while (std::getline(filestream, line)) {
+    string::size_type const name_end = line.find(':');
+    if (name_end == string::npos) continue;
+    string::size_type const password_end = line.find(':', name_end + 1);
+    if (password_end == string::npos) continue;
+    char const* const uid_begin = line.c_str() + password_end + 1;
+    char* uid_end;
+    unsigned long const uid = std::strtoul(uid_begin, &uid_end, 10);
+    if (uid_end == uid_begin || *uid_end != ':') continue;
+    // The first entry for a UID wins, as with getpwuid.
+    names_.emplace(uid_t(uid), line.substr(0, name_end));
+  }
+}
+
+std::string const& UserCache::Name(uid_t uid) {
+  if (!loaded_) Refresh();
+  auto found = names_.find(uid);
+  if (found != names_.end()) {
+    return found->second;
+  }
+  // Not in the local file: ask NSS, and fall back to the numeric UID.
+  struct passwd entry;
+  struct passwd* result{nullptr};
+  long const size_hint = sysconf(_SC_GETPW_R_SIZE_MAX);
+  std::vector<char> buffer(size_hint > 0 ? size_t(size_hint) : 1024);
+  string name = std::to_string(uid);
+  if (getpwuid_r(uid, &entry, buffer.data(), buffer.size(), &result) == 0 &&
+      result != nullptr) {
+    name = result->pw_name;
+  }
+  return names_.emplace(uid, std::move(name)).first->second;
+}
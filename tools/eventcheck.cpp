@@ -0,0 +1,104 @@
+// Check that process events catch every short-lived process.
+//
+//   eventcheck [SIZE...]
+//
+// Forks bursts of SIZE children each (default 10, 100 and 1000) that exit
+// at once, between two listings, and checks that each child's PID comes
+// back from ProcEvents as short-lived. Other processes on the host may show
+// up as well; only the children are checked. Exits 0 when every child was
+// seen, 1 when any was missed or the proc connector is unavailable.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "proc_events.h"
+
+namespace {
+// How long the listener thread gets to apply a burst's exits.
+auto const kTimeout = std::chrono::seconds(5);
+
+int Usage() {
+  std::fprintf(stderr, "usage: eventcheck [SIZE...]\n");
+  return 2;
+}
+
+// Fork size children that exit immediately and return the PIDs of those
+// that were reported short-lived. children is replaced with every PID
+// forked.
+std::unordered_set<int> Burst(ProcEvents& events, int size,
+                              std::vector<int>& children) {
+  std::vector<int> pids;
+  std::vector<int> short_lived;
+  ProcEventCounts counts;
+  events.Pids(pids, counts);
+
+  children.clear();
+  for (int i = 0; i < size; ++i) {
+    pid_t const child = fork();
+    if (child == 0) _exit(0);
+    if (child > 0) children.push_back(child);
+  }
+  for (int child : children) waitpid(child, nullptr, 0);
+
+  // The exits are queued on the socket once wait() returns, but the
+  // listener thread may not have applied them yet.
+  std::unordered_set<int> seen;
+  auto const deadline = std::chrono::steady_clock::now() + kTimeout;
+  auto missing = [&] {
+    return std::any_of(children.begin(), children.end(),
+                       [&](int child) { return seen.count(child) == 0; });
+  };
+  while (missing() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    events.Pids(pids, counts, &short_lived);
+    seen.insert(short_lived.begin(), short_lived.end());
+  }
+  return seen;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<int> sizes;
+  for (int i = 1; i < argc; ++i) {
+    char* end{nullptr};
+    long const size = std::strtol(argv[i], &end, 10);
+    if (*end != '\0' || size <= 0 || size > 100000) return Usage();
+    sizes.push_back(int(size));
+  }
+  if (sizes.empty()) sizes = {10, 100, 1000};
+
+  ProcEvents events;
+  if (!events.Start()) {
+    std::fprintf(stderr, "eventcheck: process events unavailable: %s\n",
+                 std::strerror(errno));
+    return 1;
+  }
+
+  int failures{0};
+  std::vector<int> children;
+  for (int size : sizes) {
+    std::unordered_set<int> const seen = Burst(events, size, children);
+    std::vector<int> missed;
+    for (int child : children) {
+      if (seen.count(child) == 0) missed.push_back(child);
+    }
+    std::printf("burst of %d: %zu forked, %zu missed\n", size,
+                children.size(), missed.size());
+    if (int(children.size()) != size || !missed.empty()) ++failures;
+    for (std::size_t i = 0; i < missed.size() && i < 10; ++i) {
+      std::printf("  missed %d\n", missed[i]);
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+// Build /proc trees for reproducible collection runs.
+//
+//   procfake synth OUT [--pids=N] [--seed=S] [--cpus=N]
+//   procfake cgroups OUT [--pids=N] [--seed=S]
+//   procfake capture OUT.tar
+//
+// synth writes a tree with N fake processes (default 10000); cgroups writes
+// the cgroup hierarchy the same N processes sit in; capture copies the files
+// the monitor reads from the live /proc, each thread's task/<tid>/stat and
+// smaps_rollup included, skipping those the caller may not read. OUT ending
+// in ".tar" is written as a tar archive for SnapshotSource, anything else as
+// a directory for DirectorySource. Either can be passed to the monitor with
+// --proc, or with --cgroup-root for cgroups.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "linux_parser.h"
+#include "proc_source.h"
+#include "proc_synth.h"
+
+namespace {
+// Receives the files of a tree, by path relative to the /proc root.
+class TreeWriter {
+ public:
+  virtual ~TreeWriter() = default;
+  virtual bool Write(std::string const& path, std::string const& contents) = 0;
+  virtual bool Finish() { return true; }
+};
+
+class DirectoryWriter : public TreeWriter {
+ public:
+  explicit DirectoryWriter(std::string root) : root_(std::move(root)) {
+    mkdir(root_.c_str(), 0755);
+  }
+
+  bool Write(std::string const& path, std::string const& contents) override {
+    // Create the parent directories on the way down.
+    std::string const full = root_ + path;
+    for (size_t slash = full.find('/', root_.size() + 1);
+         slash != std::string::npos; slash = full.find('/', slash + 1)) {
+      std::string const directory = full.substr(0, slash);
+      if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+      }
+    }
+    FILE* file = std::fopen(full.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool const ok =
+        std::fwrite(contents.data(), 1, contents.size(), file) ==
+        contents.size();
+    return std::fclose(file) == 0 && ok;
+  }
+
+ private:
+  std::string root_;
+};
+
+// Plain ustar: member names are the paths without their leading '/'.
+class TarWriter : public TreeWriter {
+ public:
+  explicit TarWriter(std::string const& path)
+      : file_(std::fopen(path.c_str(), "wb")) {}
+  ~TarWriter() override {
+    if (file_ != nullptr) std::fclose(file_);
+  }
+
+  bool Write(std::string const& path, std::string const& contents) override {
+    if (file_ == nullptr) return false;
+    std::string const name = path.substr(1);
+    char header[512]{};
+    if (name.size() >= 100) {
+      size_t const split = name.rfind('/', 154);
+      if (split == std::string::npos || name.size() - split - 1 >= 100) {
+        return false;
+      }
+      std::memcpy(header + 345, name.data(), split);
+      std::memcpy(header, name.data() + split + 1, name.size() - split - 1);
+    } else {
+      std::memcpy(header, name.data(), name.size());
+    }
+    std::snprintf(header + 100, 8, "%07o", 0444);
+    std::snprintf(header + 108, 8, "%07o", 0);
+    std::snprintf(header + 116, 8, "%07o", 0);
+    std::snprintf(header + 124, 12, "%011zo", contents.size());
+    std::snprintf(header + 136, 12, "%011o", 0);
+    header[156] = '0';
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+    std::memset(header + 148, ' ', 8);
+    unsigned checksum{0};
+    for (unsigned char c : header) checksum += c;
+    std::snprintf(header + 148, 8, "%06o", checksum);
+    static char const kPadding[512]{};
+    size_t const padding = (512 - contents.size() % 512) % 512;
+    return std::fwrite(header, 1, 512, file_) == 512 &&
+           std::fwrite(contents.data(), 1, contents.size(), file_) ==
+               contents.size() &&
+           std::fwrite(kPadding, 1, padding, file_) == padding;
+  }
+
+  bool Finish() override {
+    static char const kEnd[1024]{};
+    bool const ok = file_ != nullptr &&
+                    std::fwrite(kEnd, 1, sizeof(kEnd), file_) == sizeof(kEnd) &&
+                    std::fclose(file_) == 0;
+    file_ = nullptr;
+    return ok;
+  }
+
+ private:
+  FILE* file_;
+};
+
+
+// Copy the files the monitor reads, for every PID still alive; files the
+// kernel refuses to show are left out.
+bool Capture(TreeWriter& out) {
+  ProcSource const& live = ProcSource::Live();
+  std::vector<char> buffer;
+  auto copy = [&](std::string const& path) {
+    ssize_t const length = live.Read(path.c_str(), buffer);
+    return length < 0 ||
+           out.Write(path, std::string(buffer.data(), size_t(length)));
+  };
+  bool ok{true};
+  for (char const* path : {"/stat", "/uptime", "/version", "/meminfo",
+                           "/diskstats", "/net/dev"}) {
+    ok = ok && copy(path);
+  }
+  std::vector<int> pids;
+  std::vector<int> tids;
+  live.Pids(pids);
+  for (int pid : pids) {
+    std::string const base = "/" + std::to_string(pid);
+    for (std::string const& file :
+         {LinuxParser::kStatFilename, LinuxParser::kStatusFilename,
+          LinuxParser::kCmdlineFilename, LinuxParser::kStatmFilename,
+          LinuxParser::kIoFilename, LinuxParser::kSmapsRollupFilename,
+          LinuxParser::kCgroupFilename}) {
+      ok = ok && copy(base + file);
+    }
+    // Threads, for the per-thread CPU view.
+    if (!live.Tasks(pid, tids)) continue;
+    for (int tid : tids) {
+      ok = ok && copy(base + "/task/" + std::to_string(tid) +
+                      LinuxParser::kStatFilename);
+    }
+  }
+  return ok;
+}
+
+void Usage(char const* program) {
+  std::fprintf(stderr,
+               "usage: %s synth OUT [--pids=N] [--seed=S] [--cpus=N]\n"
+               "       %s cgroups OUT [--pids=N] [--seed=S]\n"
+               "       %s capture OUT.tar\n"
+               "OUT ending in .tar is written as a tar archive, anything "
+               "else as a directory.\n",
+               program, program, program);
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    Usage(argv[0]);
+    return 2;
+  }
+  std::string const command = argv[1];
+  std::string const output = argv[2];
+  int pids{10000};
+  int cpus{8};
+  unsigned seed{1};
+  for (int i = 3; i < argc; ++i) {
+    if (std::strncmp(argv[i], "--pids=", 7) == 0) {
+      pids = std::atoi(argv[i] + 7);
+    } else if (std::strncmp(argv[i], "--seed=", 7) == 0) {
+      seed = unsigned(std::strtoul(argv[i] + 7, nullptr, 10));
+    } else if (std::strncmp(argv[i], "--cpus=", 7) == 0) {
+      cpus = std::max(1, std::atoi(argv[i] + 7));
+    } else {
+      Usage(argv[0]);
+      return 2;
+    }
+  }
+
+  bool const tar = output.size() > 4 &&
+                   output.compare(output.size() - 4, 4, ".tar") == 0;
+  std::unique_ptr<TreeWriter> writer;
+  if (tar) {
+    writer = std::make_unique<TarWriter>(output);
+  } else {
+    writer = std::make_unique<DirectoryWriter>(output);
+  }
+  bool ok;
+  if (command == "synth") {
+    ok = ProcSynth::Synthesize(
+        [&writer](std::string const& path, std::string const& contents) {
+          return writer->Write(path, contents);
+        },
+        pids, cpus, seed);
+  } else if (command == "cgroups") {
+    ok = ProcSynth::SynthesizeCgroups(
+        [&writer](std::string const& path, std::string const& contents) {
+          return writer->Write(path, contents);
+        },
+        pids, seed);
+  } else if (command == "capture") {
+    ok = Capture(*writer);
+  } else {
+    Usage(argv[0]);
+    return 2;
+  }
+  ok = writer->Finish() && ok;
+  if (!ok) {
+    std::fprintf(stderr, "%s: writing %s failed: %s\n", argv[0],
+                 output.c_str(), std::strerror(errno));
+    return 1;
+  }
+  return 0;
+}